@@ -1,13 +1,34 @@
+#include <algorithm>
+#include <chrono>
 #include <iostream>
 #include <ostream>
 #include <string>
 #include <istream>
 #include <climits>
+#include <cmath>
+#include <cstdio>
+#include <deque>
+#include <fstream>
 #include <map>
+#include <memory>
 #include <sstream>
+#include <thread>
 #include <vector>
 
+#include "centrality.h"
+#include "components.h"
+#include "distancetable.h"
+#include "edgeindex.h"
+#include "externalgraph.h"
 #include "graph.h"
+#include "graphgenerator.h"
+#include "indexedgraph.h"
+#include "kshortestpaths.h"
+#include "partition.h"
+#include "pathcache.h"
+#include "queryserver.h"
+#include "shardedgraph.h"
+#include "spanningforest.h"
 
 ////////////////////////////////////////////////////////////////////////////////
 // This is 80 characters - Keep all lines under 80 characters                 //
@@ -184,9 +205,914 @@ void testGraph2() {
          << "Djisktra O" << endl;
 }
 
+void testBasicGraph() {
+    cout << "testBasicGraph" << endl;
+
+    // 3 billion does not fit in an int
+    BasicGraph<int, long long> big;
+    big.add(1, 2, 3000000000LL);
+    big.add(2, 3, 3000000000LL);
+    map<int, long long> bigWeight;
+    map<int, int> bigPrevious;
+    big.djikstraCostToAllVertices(1, bigWeight, bigPrevious);
+    cout << isOK(bigWeight[3], 6000000000LL) << "long long weights" << endl;
+
+    // unweighted costs are hop counts
+    BasicGraph<int, Unweighted> hops;
+    hops.add(1, 2);
+    hops.add(2, 3);
+    hops.add(1, 3);
+    map<int, int> hopWeight;
+    map<int, int> hopPrevious;
+    hops.djikstraCostToAllVertices(1, hopWeight, hopPrevious);
+    cout << isOK(hopWeight[3], 1) << "unweighted hop count" << endl;
+    cout << isOK(hops.getEdgeWeight(2, 3), 1) << "unweighted edge" << endl;
+
+    // undirected edges can be walked backwards
+    BasicGraph<string, int, false> undirected;
+    undirected.readFile("graph0.txt");
+    cout << isOK(undirected.getNumEdges(), 3) << "3 undirected edges" << endl;
+    graphOut.str("");
+    undirected.breadthFirstTraversal("C", graphVisitor);
+    cout << isOK(graphOut.str(), "C A B "s) << "undirected BFS" << endl;
+}
+
+void testIndexedGraph() {
+    cout << "testIndexedGraph" << endl;
+    Graph g;
+    g.readFile("graph2.txt");
+    IndexedGraph indexed(g);
+    cout << isOK(indexed.getNumVertices(), 21) << "21 vertices" << endl;
+    cout << isOK(indexed.getNumEdges(), 24) << "24 edges" << endl;
+
+    // renumbering must not change what the traversals visit, or when
+    VertexOrdering orderings[] = {VertexOrdering::Label,
+                                  VertexOrdering::Degree,
+                                  VertexOrdering::BreadthFirst,
+                                  VertexOrdering::ReverseCuthillMcKee};
+    // nor may compressing the adjacency
+    for (bool compressed : {false, true}) {
+        for (VertexOrdering ordering : orderings) {
+            if (compressed) {
+                indexed.compress();
+            } else {
+                indexed.decompress();
+            }
+            indexed.reorder(ordering);
+            string name = (compressed ? "compressed, ordering "s
+                                      : "ordering "s) +
+                          to_string(static_cast<int>(ordering));
+            graphOut.str("");
+            indexed.depthFirstTraversal("A", graphVisitor);
+            cout << isOK(graphOut.str(), "A B E F J C G K L D H M I N "s)
+                 << "DFS from A, " << name << endl;
+            graphOut.str("");
+            indexed.breadthFirstTraversal("A", graphVisitor);
+            cout << isOK(graphOut.str(), "A B C D E F G H I J K L M N "s)
+                 << "BFS from A, " << name << endl;
+        }
+    }
+    cout << isOK(indexed.getNumEdges(), 24) << "24 compressed edges" << endl;
+
+    // weights survive bit packing
+    int id = indexed.getId("O");
+    vector<int> neighbors;
+    vector<int> costs;
+    indexed.getNeighbors(id, neighbors, &costs);
+    ostringstream row;
+    for (size_t i = 0; i < neighbors.size(); ++i) {
+        row << indexed.getLabel(neighbors[i]) << "(" << costs[i] << ") ";
+    }
+    cout << isOK(row.str(), "P(5) Q(2) "s) << "compressed costs" << endl;
+}
+
+void testComponents() {
+    cout << "testComponents" << endl;
+    Graph g;
+    g.readFile("graph2.txt");
+    IndexedGraph indexed(g);
+    // more workers than this machine may have, to exercise the linking
+    Components components(indexed, 4);
+    cout << isOK(components.getNumWeakComponents(), 2)
+         << "2 weak components" << endl;
+    // O P Q R S T form a cycle, U and A to N are on their own
+    cout << isOK(components.getNumStrongComponents(), 16)
+         << "16 strong components" << endl;
+    cout << isOK(components.isUnreachable("A", "O"), true)
+         << "A cannot reach O" << endl;
+    cout << isOK(components.isUnreachable("A", "N"), false)
+         << "A may reach N" << endl;
+    cout << isOK(components.isUnreachable("A", "Z"), true)
+         << "no vertex Z" << endl;
+    cout << isOK(components.isMutuallyReachable("O", "T"), true)
+         << "O and T reach each other" << endl;
+    cout << isOK(components.isMutuallyReachable("S", "U"), false)
+         << "S and U do not" << endl;
+}
+
+void testCentrality() {
+    cout << "testCentrality" << endl;
+    Graph g;
+    g.readFile("graph0.txt");
+    IndexedGraph indexed(g);
+    Centrality centrality(indexed, 2);
+    int iterations = centrality.pageRank();
+    cout << isOK(iterations > 1 && iterations < 100, true)
+         << "converged in " << iterations << " iterations" << endl;
+    double a = centrality.getPageRank("A");
+    double b = centrality.getPageRank("B");
+    double c = centrality.getPageRank("C");
+    cout << isOK(fabs(a + b + c - 1) < 1e-6, true) << "ranks add to 1" << endl;
+    // C is pointed at by both others, A by nobody
+    cout << isOK(c > b && b > a, true) << "C > B > A" << endl;
+    cout << isOK(centrality.getInDegree("C"), 2) << "C in degree" << endl;
+    cout << isOK(centrality.getOutDegree("A"), 2) << "A out degree" << endl;
+    cout << isOK(centrality.getDegreeCentrality("B"), 1.0)
+         << "B degree centrality" << endl;
+
+    // the workers wait between iterations, they must match one thread
+    Graph bigger;
+    bigger.readFile("graph2.txt");
+    IndexedGraph indexedBigger(bigger);
+    Centrality single(indexedBigger, 1);
+    Centrality pooled(indexedBigger, 3);
+    int singleIterations = single.pageRank();
+    cout << isOK(pooled.pageRank(), singleIterations)
+         << "3 workers, same iterations" << endl;
+    // the range totals add up in another order, so allow for rounding
+    double apart = 0;
+    for (size_t v = 0; v < single.getPageRanks().size(); ++v) {
+        apart = max(apart, fabs(pooled.getPageRanks()[v] -
+                                single.getPageRanks()[v]));
+    }
+    cout << isOK(apart < 1e-12, true) << "3 workers, same ranks" << endl;
+}
+
+void testSpanningForest() {
+    cout << "testSpanningForest" << endl;
+    Graph g;
+    g.readFile("graph0.txt");
+    IndexedGraph indexed(g);
+    SpanningForest forest(indexed, 2);
+    ostringstream picked;
+    for (const SpanningForest::TreeEdge& edge : forest.getEdges()) {
+        picked << edge.from << edge.to << "(" << edge.cost << ") ";
+    }
+    cout << isOK(picked.str(), "AB(1) BC(3) "s) << "graph0 forest" << endl;
+    cout << isOK(forest.getTotalWeight(), 4) << "graph0 weight" << endl;
+
+    // A to H is the heaviest edge on the cycle, X Y is a tree of its own
+    Graph g1;
+    g1.readFile("graph1.txt");
+    IndexedGraph indexed1(g1);
+    SpanningForest forest1(indexed1, 4);
+    cout << isOK(forest1.getTotalWeight(), 17) << "graph1 weight" << endl;
+    cout << isOK(forest1.getNumTrees(), 2) << "graph1 trees" << endl;
+    cout << isOK(static_cast<int>(forest1.getEdges().size()), 8)
+         << "graph1 edges" << endl;
+}
+
+void testPathCache() {
+    cout << "testPathCache" << endl;
+    Graph g;
+    g.readFile("graph1.txt");
+    PathCache cache(g);
+    // A H G (4) is cheaper than going down the chain (6)
+    cout << isOK(cache.getCost("A", "G"), 4) << "A to G" << endl;
+    ostringstream path;
+    for (const string& label : cache.getPath("A", "G")) {
+        path << label << " ";
+    }
+    cout << isOK(path.str(), "A H G "s) << "path A to G" << endl;
+    cout << isOK(cache.getCost("A", "Y"), INT_MAX) << "A to Y" << endl;
+    cout << isOK(cache.getPath("A", "Y").empty(), true) << "no path" << endl;
+
+    // same costs as Graph's Djikstra, served from the cached tree
+    map<string, int> cachedWeight;
+    map<string, string> cachedPrevious;
+    cache.djikstraCostToAllVertices("A", cachedWeight, cachedPrevious);
+    cout << isOK(cachedWeight.size(), static_cast<size_t>(7))
+         << "7 reached" << endl;
+    cout << isOK(cachedPrevious["F"], "E"s) << "F via E" << endl;
+    cout << isOK(static_cast<int>(cache.getStats().misses), 1)
+         << "1 miss" << endl;
+    cout << isOK(static_cast<int>(cache.getStats().hits), 4)
+         << "4 hits" << endl;
+
+    // a new edge makes every tree stale
+    g.add("G", "B", 1);
+    cout << isOK(cache.getCost("A", "B"), 1) << "A to B after add" << endl;
+    cout << isOK(static_cast<int>(cache.getStats().invalidations), 1)
+         << "1 invalidation" << endl;
+
+    // room for one tree, the older one goes
+    PathCache small(g, cache.getTree("A")->bytes());
+    small.getTree("A");
+    small.getTree("B");
+    cout << isOK(small.getNumTrees(), 1) << "1 tree in budget" << endl;
+    cout << isOK(static_cast<int>(small.getStats().evictions), 1)
+         << "1 eviction" << endl;
+
+    // lookup and insert apart, the way threads sharing a lock use them
+    PathCache shared(g);
+    cout << isOK(shared.findTree("A") == nullptr, true) << "not cached yet"
+         << endl;
+    shared_ptr<const PathCache::Snapshot> before = shared.getSnapshot();
+    shared.addTree("A", PathCache::computeTree(before, before->getId("A")));
+    cout << isOK(shared.findTree("A")->distance ==
+                     cache.getTree("A")->distance,
+                 true)
+         << "computed tree cached" << endl;
+    cout << isOK(static_cast<int>(shared.getStats().misses), 1)
+         << "insert counts a miss" << endl;
+
+    // a tree computed before the graph changed is not cached after it,
+    // and the snapshot it was computed from outlives the rebuild
+    shared_ptr<const PathCache::Tree> stale =
+        PathCache::computeTree(before, before->getId("B"));
+    before.reset();
+    g.add("H", "B", 1);
+    shared.addTree("B", stale);
+    cout << isOK(shared.findTree("B") == nullptr, true)
+         << "stale tree dropped" << endl;
+    cout << isOK(stale->snapshot->getLabel(stale->previous[
+                     stale->snapshot->getId("G")]),
+                 "F"s)
+         << "old snapshot kept by its tree" << endl;
+
+    // a snapshot already built elsewhere is used as is, not copied
+    shared_ptr<const IndexedGraph> indexed = make_shared<IndexedGraph>(g);
+    PathCache fixed(indexed);
+    cout << isOK(fixed.getCost("A", "G"), 4) << "A to G over a given snapshot"
+         << endl;
+    cout << isOK(fixed.getSnapshot() == indexed, true)
+         << "snapshot not copied" << endl;
+}
+
+void testEdgeIndex() {
+    cout << "testEdgeIndex" << endl;
+    Graph g;
+    g.readFile("graph2.txt");
+    cout << isOK(g.getEdgeWeight("O", "Z"), INT_MAX) << "no vertex Z" << endl;
+    cout << isOK(g.getEdgeWeight("Z", "O"), INT_MAX) << "from no vertex"
+         << endl;
+
+    IndexedGraph indexed(g);
+    EdgeIndex index(indexed);
+    int s = indexed.getId("S");
+    int u = indexed.getId("U");
+    cout << isOK(index.getEdgeWeight(s, u), 3) << "S to U" << endl;
+    cout << isOK(index.getEdgeWeight(u, s), INT_MAX) << "U to S" << endl;
+    cout << isOK(indexed.getEdgeWeight(s, u), 3) << "S to U, row scan"
+         << endl;
+
+    // the cycle O P Q R S T in the bit matrix, U stays in the hash
+    vector<int> cycle;
+    for (const char* label : {"O", "P", "Q", "R", "S", "T"}) {
+        cycle.push_back(indexed.getId(label));
+    }
+    index.setDenseSubset(cycle);
+    vector<pair<int, int>> pairs;
+    const char* ends[][2] = {{"P", "R"}, {"R", "O"}, {"O", "R"},
+                             {"S", "U"}, {"T", "O"}, {"A", "B"},
+                             {"Z", "A"}};
+    for (const auto& end : ends) {
+        pairs.emplace_back(indexed.getId(end[0]), indexed.getId(end[1]));
+    }
+    vector<int> dense;
+    vector<int> scanned;
+    index.getEdgeWeights(pairs, dense);
+    indexed.getEdgeWeights(pairs, scanned);
+    ostringstream weights;
+    for (size_t i = 0; i < dense.size(); ++i) {
+        weights << (dense[i] == INT_MAX ? -1 : dense[i]) << " ";
+    }
+    cout << isOK(weights.str(), "2 1 -1 3 8 0 -1 "s) << "batch weights" << endl;
+    cout << isOK(dense == scanned, true) << "index matches row scan" << endl;
+
+    // ids past the last vertex are missing like -1, and a dense subset
+    // with repeats and outside ids keeps each vertex once
+    int n = indexed.getNumVertices();
+    cycle.insert(cycle.end(), {cycle[0], cycle[3], n, -2});
+    index.setDenseSubset(cycle);
+    pairs.emplace_back(n, s);
+    pairs.emplace_back(s, n + 100);
+    index.getEdgeWeights(pairs, dense);
+    indexed.getEdgeWeights(pairs, scanned);
+    weights.str("");
+    for (size_t i = 0; i < dense.size(); ++i) {
+        weights << (dense[i] == INT_MAX ? -1 : dense[i]) << " ";
+    }
+    cout << isOK(weights.str(), "2 1 -1 3 8 0 -1 -1 -1 "s)
+         << "ids outside the graph, repeated dense ids" << endl;
+    cout << isOK(dense == scanned, true) << "row scan agrees" << endl;
+}
+
+void testKShortestPaths() {
+    cout << "testKShortestPaths" << endl;
+    Graph g;
+    g.readFile("graph2.txt");
+    IndexedGraph indexed(g);
+    KShortestPaths router(indexed);
+    ostringstream routes;
+    for (const KShortestPaths::Path& path : router.find("O", "U", 3)) {
+        routes << path.cost;
+        for (const string& label : path.labels) {
+            routes << " " << label;
+        }
+        routes << ", ";
+    }
+    cout << isOK(routes.str(), "9 O Q R S U, 13 O P R S U, "s)
+         << "only 2 loopless routes O to U" << endl;
+    cout << isOK(router.find("O", "A", 3).empty(), true) << "no route O to A"
+         << endl;
+    cout << isOK(static_cast<int>(router.find("O", "R", 1).size()), 1)
+         << "k = 1" << endl;
+
+    Graph g0;
+    g0.readFile("graph0.txt");
+    IndexedGraph indexed0(g0);
+    KShortestPaths router0(indexed0);
+    vector<KShortestPaths::Path> paths = router0.find("A", "C", 5);
+    cout << isOK(static_cast<int>(paths.size()), 2) << "2 routes A to C"
+         << endl;
+    cout << isOK(paths.back().cost, 8) << "direct edge second" << endl;
+}
+
+void testDistanceTable() {
+    cout << "testDistanceTable" << endl;
+    Graph g;
+    g.readFile("graph2.txt");
+    IndexedGraph indexed(g);
+    DistanceTable table(indexed, 2);
+    table.compute({"O", "S", "A"}, {"U", "R", "O", "Z"});
+    ostringstream costs;
+    for (int cost : table.getCosts()) {
+        costs << (cost == INT_MAX ? -1 : cost) << " ";
+    }
+    cout << isOK(costs.str(), "9 3 0 -1 3 1 2 -1 -1 -1 -1 -1 "s)
+         << "3 x 4 table" << endl;
+    cout << isOK(table.getCost(1, 2), 2) << "S to O" << endl;
+
+    // fewer targets than sources, searched backwards from the targets
+    table.compute({"O", "S", "A"}, {"U", "O"});
+    cout << isOK(static_cast<int>(table.getNumTargets()), 2) << "2 targets"
+         << endl;
+    cout << isOK(table.getCost(0, 0), 9) << "O to U backwards" << endl;
+    cout << isOK(table.getCost(1, 1), 2) << "S to O backwards" << endl;
+    cout << isOK(table.getCost(2, 1), INT_MAX) << "A to O backwards" << endl;
+}
+
+// keeps what a generator sends, from to weight flattened
+class CollectingSink : public EdgeSink {
+ public:
+    int begins {0};
+    int ends {0};
+    uint64_t vertexCount {0};
+    uint64_t edgeCount {0};
+    vector<int64_t> edges;
+
+    void begin(uint64_t vertices, uint64_t count) override {
+        ++begins;
+        vertexCount = vertices;
+        edgeCount = count;
+    }
+    void edge(uint32_t from, uint32_t to, int weight) override {
+        edges.insert(edges.end(), {from, to, weight});
+    }
+    void end() override { ++ends; }
+};
+
+void testGraphGenerator() {
+    cout << "testGraphGenerator" << endl;
+    GeneratorOptions options;
+    options.vertices = 100;
+    options.edges = 400;
+    options.seed = 7;
+    string error;
+    // grid rounds to 10 x 10, 4 * 10 * 9 edges; geometric counts its own
+    const char* names[] = {"chain", "grid", "erdos-renyi", "rmat",
+                           "geometric"};
+    const uint64_t expected[] = {99, 360, 400, 400, 0};
+    for (int t = 0; t < 5; ++t) {
+        GraphGenerator::parseTopology(names[t], options.topology);
+        GraphGenerator generator(options);
+        CollectingSink first;
+        CollectingSink second;
+        generator.generate(first, error);
+        generator.generate(second, error);
+        uint64_t count = first.edges.size() / 3;
+        bool exact = first.begins == 1 && first.ends == 1 &&
+                     first.edgeCount == count &&
+                     generator.edgeCount() == count &&
+                     (expected[t] == 0 ? count > 0 : count == expected[t]);
+        cout << isOK(exact, true) << names[t] << " emits edgeCount edges"
+             << endl;
+        bool valid = first.vertexCount == generator.vertexCount();
+        for (size_t e = 0; e < first.edges.size(); e += 3) {
+            valid = valid && first.edges[e] != first.edges[e + 1] &&
+                    first.edges[e] < int64_t(first.vertexCount) &&
+                    first.edges[e + 1] < int64_t(first.vertexCount) &&
+                    first.edges[e + 2] >= 1 && first.edges[e + 2] <= 100;
+        }
+        cout << isOK(valid, true) << names[t]
+             << " ids and weights in range, no self loops" << endl;
+        cout << isOK(first.edges == second.edges, true) << names[t]
+             << " same seed, same edges" << endl;
+    }
+
+    // a radius far below the point spacing, then no edges at all
+    options.topology = Topology::Geometric;
+    options.vertices = 100000;
+    options.edges = 10;
+    GraphGenerator sparse(options);
+    CollectingSink few;
+    sparse.generate(few, error);
+    cout << isOK(few.edgeCount == few.edges.size() / 3 &&
+                     few.edgeCount == sparse.edgeCount(),
+                 true)
+         << "geometric with a tiny radius" << endl;
+    options.edges = 0;
+    CollectingSink none;
+    GraphGenerator(options).generate(none, error);
+    cout << isOK(none.begins == 1 && none.edgeCount == 0 &&
+                     none.edges.empty(),
+                 true)
+         << "geometric with no edges" << endl;
+
+    // the binary header and records read back as written
+    options.topology = Topology::Rmat;
+    options.vertices = 100;
+    options.edges = 400;
+    CollectingSink sent;
+    GraphGenerator(options).generate(sent, error);
+    ostringstream binary;
+    BinaryEdgeWriter writer(binary);
+    GraphGenerator(options).generate(writer, error);
+    istringstream in(binary.str());
+    char magic[4];
+    uint32_t version = 0;
+    uint64_t header[2] = {0, 0};
+    in.read(magic, sizeof(magic));
+    in.read(reinterpret_cast<char*>(&version), sizeof(version));
+    in.read(reinterpret_cast<char*>(header), sizeof(header));
+    vector<int64_t> records;
+    BinaryEdgeRecord record;
+    while (in.read(reinterpret_cast<char*>(&record), sizeof(record))) {
+        records.insert(records.end(), {record.from, record.to, record.weight});
+    }
+    cout << isOK(equal(magic, magic + 4, kBinaryEdgeMagic) &&
+                     version == kBinaryEdgeVersion && header[0] == 100 &&
+                     header[1] == 400,
+                 true)
+         << "binary header" << endl;
+    cout << isOK(records == sent.edges, true) << "binary records" << endl;
+
+    // ids past 32 bits and negative weights are refused, nothing is sent
+    options.vertices = uint64_t(1) << 32;
+    CollectingSink refused;
+    cout << isOK(GraphGenerator(options).generate(refused, error), false)
+         << "2^32 vertices refused: " << error << endl;
+    options.vertices = 100;
+    options.minWeight = -1;
+    cout << isOK(GraphGenerator(options).generate(refused, error), false)
+         << "negative weight refused: " << error << endl;
+    cout << isOK(refused.begins == 0 && refused.edges.empty(), true)
+         << "nothing sent when refused" << endl;
+}
+
+void testExternalGraph() {
+    cout << "testExternalGraph" << endl;
+    // 0 1 2 3 4 reach each other one way or another, 5 and 6 point at
+    // each other, 7 has no edges; written out of order
+    {
+        ofstream file("external-unsorted.bin", ios::out | ios::binary);
+        BinaryEdgeWriter writer(file);
+        writer.begin(8, 8);
+        const uint32_t edges[][2] = {{3, 4}, {0, 1}, {1, 2}, {0, 3},
+                                     {2, 0}, {5, 6}, {6, 5}, {4, 1}};
+        for (const auto& edge : edges) {
+            writer.edge(edge[0], edge[1], 1);
+        }
+        writer.end();
+    }
+    ExternalGraph graph(24);
+    string error;
+    cout << isOK(graph.open("external-unsorted.bin", error), false)
+         << "unsorted file refused" << endl;
+
+    // 3 edges a run, so the merge sees 3 runs
+    cout << isOK(ExternalGraph::sortEdgeFile("external-unsorted.bin",
+                                             "external-sorted.bin", 36,
+                                             error),
+                 true)
+         << "external sort " << error << endl;
+    cout << isOK(graph.open("external-sorted.bin", error), true)
+         << "sorted file opened " << error << endl;
+    cout << isOK(static_cast<int>(graph.getDegree(0)), 2) << "degree of 0"
+         << endl;
+
+    vector<uint32_t> level;
+    cout << isOK(static_cast<int>(graph.breadthFirstSearch(0, level)), 5)
+         << "5 reached from 0" << endl;
+    ostringstream levels;
+    for (uint32_t l : level) {
+        levels << (l == ExternalGraph::kUnreached ? -1 : int(l)) << " ";
+    }
+    cout << isOK(levels.str(), "0 1 2 1 2 -1 -1 -1 "s) << "levels" << endl;
+
+    vector<uint32_t> component;
+    cout << isOK(static_cast<int>(graph.weakComponents(component)), 3)
+         << "3 weak components" << endl;
+    cout << isOK(component[4] == component[2] && component[6] == 1 &&
+                     component[7] == 2, true)
+         << "component ids" << endl;
+    cout << isOK(graph.failed(), false) << "no short reads" << endl;
+
+    // compressed IndexedGraph straight from the file, refused unsorted
+    IndexedGraphBuilder unsorted;
+    ExternalGraph::streamEdgeFile("external-unsorted.bin", unsorted, error);
+    cout << isOK(unsorted.finish(error) == nullptr, true)
+         << "unsorted stream refused" << endl;
+    error.clear();
+    IndexedGraphBuilder builder;
+    cout << isOK(ExternalGraph::streamEdgeFile("external-sorted.bin",
+                                               builder, error),
+                 true)
+         << "file streamed " << error << endl;
+    unique_ptr<IndexedGraph> streamed = builder.finish(error);
+    cout << isOK(streamed && streamed->isCompressed() &&
+                     streamed->getNumEdges() == 8,
+                 true)
+         << "compressed from the file " << error << endl;
+    graphOut.str("");
+    if (streamed) {
+        streamed->breadthFirstTraversal("0", graphVisitor);
+    }
+    cout << isOK(graphOut.str(), "0 1 3 2 4 "s) << "BFS from 0" << endl;
+    remove("external-unsorted.bin");
+    remove("external-sorted.bin");
+}
+
+// 16 x 16 grid, edges both ways, labels r * 16 + c
+void addGrid(BasicGraph<int, int>& grid) {
+    for (int r = 0; r < 16; ++r) {
+        for (int c = 0; c < 16; ++c) {
+            int v = r * 16 + c;
+            if (c + 1 < 16) {
+                grid.add(v, v + 1, (r * 7 + c) % 5 + 1);
+                grid.add(v + 1, v, (r * 3 + c) % 4 + 1);
+            }
+            if (r + 1 < 16) {
+                grid.add(v, v + 16, (r + c * 5) % 6 + 1);
+                grid.add(v + 16, v, (r * 2 + c) % 3 + 1);
+            }
+        }
+    }
+}
+
+void testIndexedGraphBuilder() {
+    cout << "testIndexedGraphBuilder" << endl;
+    BasicGraph<int, int> grid;
+    addGrid(grid);
+    BasicIndexedGraph<int, int> compressed(grid);
+    compressed.compress();
+
+    // the rows of the grid in from order, the first one backwards with
+    // a repeated edge whose cost must be dropped
+    BasicIndexedGraphBuilder<int, int> builder;
+    builder.begin(256, 960);
+    vector<int> neighbors;
+    vector<int> costs;
+    for (int v = 0; v < 256; ++v) {
+        neighbors.clear();
+        costs.clear();
+        compressed.getNeighbors(v, neighbors, &costs);
+        if (v == 0) {
+            reverse(neighbors.begin(), neighbors.end());
+            reverse(costs.begin(), costs.end());
+        }
+        for (size_t i = 0; i < neighbors.size(); ++i) {
+            builder.edge(v, neighbors[i], costs[i]);
+        }
+        if (v == 0) {
+            builder.edge(0, neighbors[0], 99);
+        }
+    }
+    builder.end();
+    string error;
+    unique_ptr<BasicIndexedGraph<int, int>> built = builder.finish(error);
+    cout << isOK(built != nullptr, true) << "grid built " << error << endl;
+    if (!built) {
+        return;
+    }
+    cout << isOK(built->getAdjacencyBytes(),
+                 compressed.getAdjacencyBytes())
+         << "same bytes as compress()" << endl;
+    bool same = built->getNumEdges() == compressed.getNumEdges();
+    vector<int> builtNeighbors;
+    vector<int> builtCosts;
+    for (int v = 0; v < 256; ++v) {
+        neighbors.clear();
+        costs.clear();
+        builtNeighbors.clear();
+        builtCosts.clear();
+        compressed.getNeighbors(v, neighbors, &costs);
+        built->getNeighbors(v, builtNeighbors, &builtCosts);
+        same = same && neighbors == builtNeighbors && costs == builtCosts;
+    }
+    cout << isOK(same, true) << "same rows as compress()" << endl;
+
+    // what Graph::add refuses is refused here too, so a stream never
+    // builds a different graph than IndexedGraph(graph) would
+    BasicIndexedGraphBuilder<int, int> looped;
+    looped.begin(3, 2);
+    looped.edge(0, 1, 1);
+    looped.edge(1, 1, 1);
+    looped.end();
+    cout << isOK(looped.finish(error) == nullptr, true)
+         << "self loop refused: " << error << endl;
+    BasicIndexedGraphBuilder<int, int> outside;
+    outside.begin(3, 1);
+    outside.edge(0, 3, 1);
+    outside.end();
+    cout << isOK(outside.finish(error) == nullptr, true)
+         << "vertex past the count refused: " << error << endl;
+}
+
+void testPartition() {
+    cout << "testPartition" << endl;
+    // two 4-cliques joined by one edge each way
+    Graph g;
+    const string left = "ABCD";
+    const string right = "EFGH";
+    for (int i = 0; i < 4; ++i) {
+        for (int j = 0; j < 4; ++j) {
+            if (i != j) {
+                g.add(left.substr(i, 1), left.substr(j, 1), 1);
+                g.add(right.substr(i, 1), right.substr(j, 1), 1);
+            }
+        }
+    }
+    g.add("D", "E", 1);
+    g.add("E", "D", 1);
+    IndexedGraph indexed(g);
+    Partition halves(indexed, 2);
+    cout << isOK(static_cast<int>(halves.getEdgeCut()), 2)
+         << "only the bridge is cut" << endl;
+    cout << isOK(halves.getPart("A") == halves.getPart("D") &&
+                     halves.getPart("E") == halves.getPart("H") &&
+                     halves.getPart("A") != halves.getPart("H"),
+                 true)
+         << "each clique in one part" << endl;
+    cout << isOK(halves.getPart("Z"), -1) << "no part for Z" << endl;
+
+    BasicGraph<int, int> grid;
+    addGrid(grid);
+    BasicIndexedGraph<int, int> indexedGrid(grid);
+    BasicPartition<int, int> quarters(indexedGrid, 4);
+    const vector<int>& sizes = quarters.getPartSizes();
+    cout << isOK(*max_element(sizes.begin(), sizes.end()) <= 66, true)
+         << "parts within 3% of 64" << endl;
+    // quadrants cut 64 edges, a random split about 700
+    cout << isOK(quarters.getEdgeCut() <= 128, true) << "grid cut "
+         << quarters.getEdgeCut() << endl;
+}
+
+#ifndef _WIN32
+void testShardedGraph() {
+    cout << "testShardedGraph" << endl;
+    Graph g;
+    g.readFile("graph2.txt");
+    IndexedGraph indexed(g);
+    Partition thirds(indexed, 3);
+    ShardedGraph sharded(indexed, thirds);
+    string error;
+    cout << isOK(sharded.start(error), true) << "3 workers started "
+         << error << endl;
+
+    vector<int> level;
+    cout << isOK(sharded.breadthFirstSearch("A", level), 14)
+         << "14 reached from A" << endl;
+    ostringstream levels;
+    for (int l : level) {
+        levels << l << " ";
+    }
+    cout << isOK(levels.str(),
+                 "0 1 1 1 2 2 2 2 2 3 3 3 3 3 -1 -1 -1 -1 -1 -1 -1 "s)
+         << "levels" << endl;
+
+    vector<string> path;
+    cout << isOK(sharded.shortestPath("O", "U", path), 9) << "O to U"
+         << endl;
+    ostringstream labels;
+    for (const string& label : path) {
+        labels << label << " ";
+    }
+    cout << isOK(labels.str(), "O Q R S U "s) << "path O to U" << endl;
+    cout << isOK(sharded.shortestPath("O", "A", path), INT_MAX)
+         << "no path O to A" << endl;
+    cout << isOK(path.empty(), true) << "empty path" << endl;
+
+    // every cost across 4 shards matches a distance table
+    BasicGraph<int, int> grid;
+    addGrid(grid);
+    BasicIndexedGraph<int, int> indexedGrid(grid);
+    BasicPartition<int, int> quarters(indexedGrid, 4);
+    BasicShardedGraph<int, int> shardedGrid(indexedGrid, quarters);
+    shardedGrid.start(error);
+    BasicDistanceTable<int, int> table(indexedGrid, 1);
+    table.compute({0, 17, 200}, {255, 3, 128});
+    bool same = true;
+    vector<int> gridPath;
+    const int sources[] = {0, 17, 200};
+    const int targets[] = {255, 3, 128};
+    for (int s = 0; s < 3; ++s) {
+        for (int t = 0; t < 3; ++t) {
+            int cost = shardedGrid.shortestPath(sources[s], targets[t],
+                                                gridPath);
+            same = same && cost == table.getCost(s, t) &&
+                   gridPath.front() == sources[s] &&
+                   gridPath.back() == targets[t];
+        }
+    }
+    cout << isOK(same, true) << "sharded costs match" << endl;
+    cout << isOK(shardedGrid.getStats().messages > 0, true)
+         << "messages crossed shards" << endl;
+    cout << isOK(shardedGrid.breadthFirstSearch(0, level), 256)
+         << "whole grid reached" << endl;
+    cout << isOK(level[indexedGrid.getId(255)], 30) << "far corner level"
+         << endl;
+    cout << isOK(shardedGrid.failed(), false) << "no worker failed" << endl;
+}
+#endif
+
+#ifndef _WIN32
+void testQueryServer() {
+    cout << "testQueryServer" << endl;
+    Graph g;
+    g.readFile("graph1.txt");
+    ServerOptions options;
+    options.socketPath = "/tmp/assignment3-query.sock";
+    options.workers = 2;
+    QueryServer server(g, options);
+    string error;
+    cout << isOK(server.start(error), true) << "server started " << error
+         << endl;
+
+    // sent in one go, so one worker may answer several together
+    QueryClient client;
+    cout << isOK(client.connect(options.socketPath, error), true)
+         << "client connected " << error << endl;
+    vector<string> answers;
+    cout << isOK(client.queryAll({"WEIGHT A B", "PATH A G", "BFS X",
+                                  "WEIGHT A Y", "PATH A Y", "NOPE"},
+                                 answers),
+                 true)
+         << "pipelined queries" << endl;
+    answers.resize(6);
+    cout << isOK(answers[0], "OK 1"s) << "weight A to B" << endl;
+    cout << isOK(answers[1], "OK 4 A H G"s) << "path A to G" << endl;
+    cout << isOK(answers[2], "OK X Y"s) << "breadth-first from X" << endl;
+    cout << isOK(answers[3], "NONE"s) << "no edge A to Y" << endl;
+    cout << isOK(answers[4], "NONE"s) << "no path A to Y" << endl;
+    cout << isOK(answers[5], "ERR unknown request: NOPE"s) << "bad request"
+         << endl;
+
+    string answer;
+    client.query("DFS H", answer);
+    cout << isOK(answer, "OK H G"s) << "depth-first from H" << endl;
+    server.stop();
+    ServerStats stats = server.getStats();
+    cout << isOK(static_cast<int>(stats.requests), 7) << "7 requests" << endl;
+    cout << isOK(static_cast<int>(stats.connections), 1) << "1 connection"
+         << endl;
+    cout << isOK(stats.p99Micros >= stats.p50Micros, true)
+         << "p99 at least p50" << endl;
+    cout << isOK(server.handleBatch({"WEIGHT H G"})[0], "OK 1"s)
+         << "batch without socket" << endl;
+
+    // a client that floods the queue and reads nothing meanwhile gets BUSY
+    // for the overflow, keeps its answers and holds up no other client
+    options.workers = 1;
+    options.queueCapacity = 4;
+    QueryServer busy(g, options);
+    busy.start(error);
+    QueryClient flooder;
+    QueryClient other;
+    flooder.connect(options.socketPath, error);
+    other.connect(options.socketPath, error);
+    vector<string> flood(100000, "WEIGHT A B");
+    cout << isOK(flooder.send(flood), true) << "flood sent" << endl;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    int retries = 0;
+    while (other.query("WEIGHT H G", answer) && answer == "BUSY") {
+        ++retries;
+    }
+    double waited =
+        chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    cout << isOK(answer, "OK 1"s) << "second client served" << endl;
+    cout << isOK(waited < 4, true) << "second client not held up" << endl;
+    flooder.receive(flood.size(), answers);
+    int answered = static_cast<int>(count(answers.begin(), answers.end(),
+                                          "OK 1"s));
+    int rejected = static_cast<int>(count(answers.begin(), answers.end(),
+                                          "BUSY"s));
+    cout << isOK(answered + rejected, 100000)
+         << "every flood request answered" << endl;
+    cout << isOK(rejected > 0, true) << "overflow answered BUSY" << endl;
+    busy.stop();
+    cout << isOK(static_cast<int>(busy.getStats().rejected),
+                 rejected + retries)
+         << "BUSY answers counted" << endl;
+
+    // a client that shuts down its end after a batch bigger than the
+    // socket buffer still gets every answer, then the server closes
+    options.workers = 2;
+    options.queueCapacity = 100000;
+    QueryServer halfClosed(g, options);
+    halfClosed.start(error);
+    QueryClient batch;
+    batch.connect(options.socketPath, error);
+    vector<string> paths(50000, "PATH A G");
+    batch.send(paths);
+    cout << isOK(batch.finishSending(), true) << "sending end shut down"
+         << endl;
+    // read nothing until the server has seen the end, so the answers the
+    // socket did not take are still waiting on the server side
+    this_thread::sleep_for(chrono::milliseconds(200));
+    batch.receive(paths.size(), answers);
+    cout << isOK(static_cast<int>(count(answers.begin(), answers.end(),
+                                        "OK 4 A H G"s)),
+                 50000)
+         << "every answer after half-close" << endl;
+    vector<string> extra;
+    cout << isOK(batch.receive(1, extra), false)
+         << "closed after the last answer" << endl;
+    halfClosed.stop();
+}
+#endif
+
+#ifdef GRAPH_STATS
+void testGraphStats() {
+    cout << "testGraphStats" << endl;
+    Graph g;
+    g.readFile("graph0.txt");
+    g.depthFirstTraversal("A", graphVisitor);
+    g.breadthFirstTraversal("A", graphVisitor);
+    const deque<QueryStats>& queries = g.getStats().getQueries();
+    cout << isOK(static_cast<int>(queries.size()), 2) << "2 queries" << endl;
+    cout << isOK(queries[1].query, "breadthFirstTraversal"s)
+         << "query name" << endl;
+    cout << isOK(static_cast<int>(queries[1].verticesSettled), 3)
+         << "3 vertices settled" << endl;
+    cout << isOK(static_cast<int>(queries[1].edgesRelaxed), 3)
+         << "3 edges relaxed" << endl;
+
+    ostringstream trace;
+    g.getStats().writeChromeTrace(trace);
+    cout << isOK(trace.str().find("\"ph\": \"X\"") != string::npos, true)
+         << "Chrome trace" << endl;
+
+    // a long running process keeps only the newest entries
+    g.getStats().setCapacity(3);
+    for (int i = 0; i < 5; ++i) {
+        g.breadthFirstTraversal("A", graphVisitor);
+    }
+    cout << isOK(static_cast<int>(queries.size()), 3) << "capped at 3"
+         << endl;
+    cout << isOK(static_cast<int>(g.getStats().getDropped()), 4)
+         << "4 dropped" << endl;
+    ostringstream json;
+    g.getStats().writeJson(json);
+    cout << isOK(json.str().find("\"dropped\": 4") != string::npos, true)
+         << "dropped in JSON" << endl;
+}
+#endif
+
 int main() {
     testGraph0();
     testGraph1();
     testGraph2();
+    testBasicGraph();
+    testIndexedGraph();
+    testComponents();
+    testCentrality();
+    testSpanningForest();
+    testPathCache();
+    testEdgeIndex();
+    testKShortestPaths();
+    testDistanceTable();
+    testGraphGenerator();
+    testExternalGraph();
+    testIndexedGraphBuilder();
+    testPartition();
+#ifndef _WIN32
+    testQueryServer();
+    testShardedGraph();
+#endif
+#ifdef GRAPH_STATS
+    testGraphStats();
+#endif
     return 0;
 }
@@ -0,0 +1,673 @@
+/**
+ * Google Benchmark suite for the Graph class
+ * Builds synthetic graphs (chain, grid, Erdos-Renyi, R-MAT) and times
+ * readFile, add, the two traversals, Djikstra, getEdgeWeight, a
+ * PageRank iteration, the minimum spanning forest, cached shortest paths
+ * and queries over a graph sharded across worker processes
+ * Every benchmark reports edges/sec and the peak resident set size
+ */
+
+#include <benchmark/benchmark.h>
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "centrality.h"
+#include "distancetable.h"
+#include "edgeindex.h"
+#include "externalgraph.h"
+#include "graph.h"
+#include "graphgenerator.h"
+#include "indexedgraph.h"
+#include "kshortestpaths.h"
+#include "partition.h"
+#include "pathcache.h"
+#include "queryserver.h"
+#include "shardedgraph.h"
+#include "spanningforest.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// This is 80 characters - Keep all lines under 80 characters                 //
+////////////////////////////////////////////////////////////////////////////////
+
+// upper bound on vertices for the non-recursive benchmarks
+// override with -DGRAPH_BENCH_MAX_VERTICES=10000000 for the 10M runs
+#ifndef GRAPH_BENCH_MAX_VERTICES
+#define GRAPH_BENCH_MAX_VERTICES (1 << 17)
+#endif
+
+// depthFirstTraversal recurses once per vertex on a chain,
+// so keep it under the default 8MB stack
+#ifndef GRAPH_BENCH_MAX_RECURSIVE
+#define GRAPH_BENCH_MAX_RECURSIVE (1 << 14)
+#endif
+
+// djikstraCostToAllVertices also copies the whole path into every vertex,
+// quadratic on a chain
+#ifndef GRAPH_BENCH_MAX_DJIKSTRA
+#define GRAPH_BENCH_MAX_DJIKSTRA (1 << 12)
+#endif
+
+namespace {
+
+/** the synthetic topologies, used as the first benchmark argument */
+enum GraphKind { kChain, kGrid, kErdosRenyi, kRmat };
+
+const char* kindName(int kind) {
+  switch (kind) {
+    case kChain: return "chain";
+    case kGrid: return "grid";
+    case kErdosRenyi: return "erdos-renyi";
+    default: return "rmat";
+  }
+}
+
+/** from, to, weight - same as a line of graph0.txt */
+using EdgeList = std::vector<std::tuple<std::string, std::string, int>>;
+
+// average out degree for the random topologies
+const int kAverageDegree = 8;
+
+// seed for picking getEdgeWeight queries
+const unsigned kQuerySeed = 343;
+
+/** collects generated edges with decimal labels, like graphgen writes */
+class EdgeListSink : public EdgeSink {
+ public:
+  explicit EdgeListSink(EdgeList& edges) : edges(edges) {}
+
+  void begin(uint64_t, uint64_t edgeCount) override {
+    edges.reserve(edgeCount);
+  }
+
+  void edge(uint32_t from, uint32_t to, int weight) override {
+    edges.emplace_back(std::to_string(from), std::to_string(to), weight);
+  }
+
+ private:
+  EdgeList& edges;
+};
+
+/** the generator's default seed, so every run sees the same graphs */
+GeneratorOptions generatorOptions(int kind, int n) {
+  GeneratorOptions options;
+  switch (kind) {
+    case kChain: options.topology = Topology::Chain; break;
+    case kGrid: options.topology = Topology::Grid; break;
+    case kErdosRenyi: options.topology = Topology::ErdosRenyi; break;
+    default: options.topology = Topology::Rmat; break;
+  }
+  options.vertices = static_cast<uint64_t>(n);
+  options.edges = static_cast<uint64_t>(n) * kAverageDegree;
+  return options;
+}
+
+EdgeList makeEdges(int kind, int n) {
+  EdgeList edges;
+  EdgeListSink sink(edges);
+  std::string error;
+  GraphGenerator(generatorOptions(kind, n)).generate(sink, error);
+  return edges;
+}
+
+/** only one graph is kept alive at a time so peak RSS stays meaningful */
+struct CachedGraph {
+  int kind {-1};
+  int n {-1};
+  EdgeList edges;
+  std::unique_ptr<Graph> graph;
+};
+
+CachedGraph& cachedGraph(int kind, int n) {
+  static CachedGraph cache;
+  if (cache.kind != kind || cache.n != n) {
+    cache.graph.reset();
+    cache.edges = makeEdges(kind, n);
+    cache.graph.reset(new Graph());
+    for (const auto& edge : cache.edges) {
+      cache.graph->add(std::get<0>(edge), std::get<1>(edge),
+                       std::get<2>(edge));
+    }
+    cache.kind = kind;
+    cache.n = n;
+  }
+  return cache;
+}
+
+/** write edges in the "count, then from to weight" fixture format */
+void writeEdgeFile(const std::string& filename, const EdgeList& edges) {
+  std::ofstream out(filename);
+  out << edges.size() << "\n";
+  for (const auto& edge : edges) {
+    out << std::get<0>(edge) << " " << std::get<1>(edge) << " "
+        << std::get<2>(edge) << "\n";
+  }
+}
+
+/** peak resident set size in megabytes, ru_maxrss is in kilobytes */
+double peakRssMegabytes() {
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return static_cast<double>(usage.ru_maxrss) / 1024.0;
+}
+
+/** edges/sec and peak RSS, shared by every benchmark */
+void reportCounters(benchmark::State& state, int64_t edgesPerIteration) {
+  state.SetLabel(kindName(static_cast<int>(state.range(0))));
+  state.counters["edges/s"] = benchmark::Counter(
+      static_cast<double>(state.iterations() * edgesPerIteration),
+      benchmark::Counter::kIsRate);
+  state.counters["peak_rss_MB"] = peakRssMegabytes();
+}
+
+// visitor for the traversals, keeps the label alive without printing it
+void sink(const std::string& label) { benchmark::DoNotOptimize(label.data()); }
+
+/** Djikstra prints a report for every vertex, send it nowhere */
+class SilenceCout {
+ public:
+  SilenceCout() : saved(std::cout.rdbuf(nullptr)) {}
+  ~SilenceCout() { std::cout.rdbuf(saved); }
+
+ private:
+  std::streambuf* saved;
+};
+
+}  // namespace
+
+static void BM_Add(benchmark::State& state) {
+  int kind = static_cast<int>(state.range(0));
+  EdgeList edges = makeEdges(kind, static_cast<int>(state.range(1)));
+  for (auto _ : state) {
+    Graph g;
+    for (const auto& edge : edges) {
+      g.add(std::get<0>(edge), std::get<1>(edge), std::get<2>(edge));
+    }
+    benchmark::DoNotOptimize(g.getNumEdges());
+  }
+  reportCounters(state, static_cast<int64_t>(edges.size()));
+}
+
+static void BM_ReadFile(benchmark::State& state) {
+  int kind = static_cast<int>(state.range(0));
+  EdgeList edges = makeEdges(kind, static_cast<int>(state.range(1)));
+  std::ostringstream name;
+  name << "bench_" << kindName(kind) << "_" << state.range(1) << ".txt";
+  writeEdgeFile(name.str(), edges);
+  for (auto _ : state) {
+    Graph g;
+    g.readFile(name.str());
+    benchmark::DoNotOptimize(g.getNumEdges());
+  }
+  std::remove(name.str().c_str());
+  reportCounters(state, static_cast<int64_t>(edges.size()));
+}
+
+static void BM_DepthFirstTraversal(benchmark::State& state) {
+  CachedGraph& cache = cachedGraph(static_cast<int>(state.range(0)),
+                                   static_cast<int>(state.range(1)));
+  for (auto _ : state) {
+    cache.graph->depthFirstTraversal("0", sink);
+  }
+  reportCounters(state, cache.graph->getNumEdges());
+}
+
+static void BM_BreadthFirstTraversal(benchmark::State& state) {
+  CachedGraph& cache = cachedGraph(static_cast<int>(state.range(0)),
+                                   static_cast<int>(state.range(1)));
+  for (auto _ : state) {
+    cache.graph->breadthFirstTraversal("0", sink);
+  }
+  reportCounters(state, cache.graph->getNumEdges());
+}
+
+static void BM_DjikstraCostToAllVertices(benchmark::State& state) {
+  CachedGraph& cache = cachedGraph(static_cast<int>(state.range(0)),
+                                   static_cast<int>(state.range(1)));
+  std::map<std::string, int> weight;
+  std::map<std::string, std::string> previous;
+  SilenceCout quiet;
+  for (auto _ : state) {
+    cache.graph->djikstraCostToAllVertices("0", weight, previous);
+    benchmark::DoNotOptimize(weight.size());
+  }
+  reportCounters(state, cache.graph->getNumEdges());
+}
+
+// same traversal over the flat snapshot, third argument is VertexOrdering
+static void BM_IndexedBreadthFirstTraversal(benchmark::State& state) {
+  CachedGraph& cache = cachedGraph(static_cast<int>(state.range(0)),
+                                   static_cast<int>(state.range(1)));
+  IndexedGraph indexed(*cache.graph);
+  indexed.reorder(static_cast<VertexOrdering>(state.range(2)));
+  for (auto _ : state) {
+    indexed.breadthFirstTraversal("0", sink);
+  }
+  reportCounters(state, indexed.getNumEdges());
+}
+
+// compressed adjacency, adjacency_bytes/edge shows what it saves
+static void BM_CompressedBreadthFirstTraversal(benchmark::State& state) {
+  CachedGraph& cache = cachedGraph(static_cast<int>(state.range(0)),
+                                   static_cast<int>(state.range(1)));
+  IndexedGraph indexed(*cache.graph);
+  indexed.reorder(static_cast<VertexOrdering>(state.range(2)));
+  indexed.compress();
+  for (auto _ : state) {
+    indexed.breadthFirstTraversal("0", sink);
+  }
+  reportCounters(state, indexed.getNumEdges());
+  state.counters["adjacency_bytes/edge"] =
+      static_cast<double>(indexed.getAdjacencyBytes()) /
+      std::max(1, indexed.getNumEdges());
+}
+
+static void BM_IndexedDepthFirstTraversal(benchmark::State& state) {
+  CachedGraph& cache = cachedGraph(static_cast<int>(state.range(0)),
+                                   static_cast<int>(state.range(1)));
+  IndexedGraph indexed(*cache.graph);
+  indexed.reorder(static_cast<VertexOrdering>(state.range(2)));
+  for (auto _ : state) {
+    indexed.depthFirstTraversal("0", sink);
+  }
+  reportCounters(state, indexed.getNumEdges());
+}
+
+// one PageRank iteration per loop, the ordering decides how scattered
+// the gathers are
+static void BM_PageRankIteration(benchmark::State& state) {
+  CachedGraph& cache = cachedGraph(static_cast<int>(state.range(0)),
+                                   static_cast<int>(state.range(1)));
+  IndexedGraph indexed(*cache.graph);
+  indexed.reorder(static_cast<VertexOrdering>(state.range(2)));
+  Centrality centrality(indexed);
+  for (auto _ : state) {
+    centrality.pageRank(0.85, 0, 1);
+  }
+  reportCounters(state, indexed.getNumEdges());
+}
+
+static void BM_SpanningForest(benchmark::State& state) {
+  CachedGraph& cache = cachedGraph(static_cast<int>(state.range(0)),
+                                   static_cast<int>(state.range(1)));
+  IndexedGraph indexed(*cache.graph);
+  for (auto _ : state) {
+    SpanningForest forest(indexed);
+    benchmark::DoNotOptimize(forest.getTotalWeight());
+  }
+  reportCounters(state, indexed.getNumEdges());
+}
+
+// ExternalGraph over a sorted binary edge file, the page cache keeps it
+// in memory at these sizes so this measures the code, not the disk
+static void BM_ExternalBreadthFirstSearch(benchmark::State& state) {
+  int kind = static_cast<int>(state.range(0));
+  int n = static_cast<int>(state.range(1));
+  std::ostringstream name;
+  name << "bench_" << kindName(kind) << "_" << n << ".bin";
+  std::string error;
+  {
+    std::ofstream out(name.str(), std::ios::out | std::ios::binary);
+    BinaryEdgeWriter writer(out);
+    GraphGenerator(generatorOptions(kind, n)).generate(writer, error);
+  }
+  ExternalGraph graph;
+  if (!ExternalGraph::sortEdgeFile(name.str(), name.str() + ".sorted",
+                                   size_t(256) << 20, error) ||
+      !graph.open(name.str() + ".sorted", error)) {
+    state.SkipWithError(error.c_str());
+    return;
+  }
+  uint64_t opened = graph.getBytesRead();
+  std::vector<uint32_t> level;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(graph.breadthFirstSearch(0, level));
+  }
+  std::remove(name.str().c_str());
+  std::remove((name.str() + ".sorted").c_str());
+  reportCounters(state, static_cast<int64_t>(graph.getNumEdges()));
+  state.counters["read_MB"] = (graph.getBytesRead() - opened) /
+                              1048576.0 / state.iterations();
+}
+
+/** count labels drawn with kQuerySeed, repeatable across runs */
+std::vector<std::string> randomLabels(int n, int count, unsigned salt) {
+  std::mt19937 rng(kQuerySeed + salt);
+  std::uniform_int_distribution<int> vertex(0, n - 1);
+  std::vector<std::string> labels;
+  for (int i = 0; i < count; ++i) {
+    labels.push_back(std::to_string(vertex(rng)));
+  }
+  return labels;
+}
+
+// 64 x 64 table, compare with 64 calls of djikstraCostToAllVertices
+static void BM_DistanceTable(benchmark::State& state) {
+  int n = static_cast<int>(state.range(1));
+  CachedGraph& cache = cachedGraph(static_cast<int>(state.range(0)), n);
+  IndexedGraph indexed(*cache.graph);
+  DistanceTable table(indexed);
+  std::vector<std::string> sources = randomLabels(n, 64, 1);
+  std::vector<std::string> targets = randomLabels(n, 64, 2);
+  for (auto _ : state) {
+    table.compute(sources, targets);
+    benchmark::DoNotOptimize(table.getCosts().data());
+  }
+  reportCounters(state, indexed.getNumEdges());
+  state.counters["settled/search"] =
+      static_cast<double>(table.getSettled()) / sources.size();
+}
+
+// 8 routes between each of 16 random pairs, every route costs a search
+// from each vertex on it, so sizes stop where Djikstra's do
+static void BM_KShortestPaths(benchmark::State& state) {
+  int n = static_cast<int>(state.range(1));
+  CachedGraph& cache = cachedGraph(static_cast<int>(state.range(0)), n);
+  IndexedGraph indexed(*cache.graph);
+  KShortestPaths router(indexed);
+  std::vector<std::string> sources = randomLabels(n, 16, 3);
+  std::vector<std::string> targets = randomLabels(n, 16, 4);
+  int searches = 0;
+  for (auto _ : state) {
+    searches = 0;
+    for (size_t i = 0; i < sources.size(); ++i) {
+      benchmark::DoNotOptimize(router.find(sources[i], targets[i], 8));
+      searches += router.getSearches();
+    }
+  }
+  reportCounters(state, indexed.getNumEdges());
+  state.counters["searches"] = searches;
+}
+
+// 8 parts, cut_fraction is the share of edges between parts
+static void BM_Partition(benchmark::State& state) {
+  CachedGraph& cache = cachedGraph(static_cast<int>(state.range(0)),
+                                   static_cast<int>(state.range(1)));
+  IndexedGraph indexed(*cache.graph);
+  int64_t cut = 0;
+  for (auto _ : state) {
+    Partition partition(indexed, 8);
+    cut = partition.getEdgeCut();
+  }
+  reportCounters(state, indexed.getNumEdges());
+  state.counters["cut_fraction"] =
+      static_cast<double>(cut) / std::max(1, indexed.getNumEdges());
+}
+
+// breadth-first search from vertex 0 over shards worker processes,
+// shards 1 is the cost of the supersteps and sockets alone
+static void BM_ShardedBreadthFirstSearch(benchmark::State& state) {
+  CachedGraph& cache = cachedGraph(static_cast<int>(state.range(0)),
+                                   static_cast<int>(state.range(1)));
+  IndexedGraph indexed(*cache.graph);
+  Partition partition(indexed, static_cast<int>(state.range(2)));
+  ShardedGraph sharded(indexed, partition);
+  std::string error;
+  if (!sharded.start(error)) {
+    state.SkipWithError(error.c_str());
+    return;
+  }
+  std::vector<int> level;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(sharded.breadthFirstSearch("0", level));
+  }
+  reportCounters(state, indexed.getNumEdges());
+  state.counters["supersteps"] = sharded.getStats().supersteps;
+  state.counters["messages"] = sharded.getStats().messages;
+}
+
+// 16 random pairs over shards worker processes
+static void BM_ShardedShortestPath(benchmark::State& state) {
+  int n = static_cast<int>(state.range(1));
+  CachedGraph& cache = cachedGraph(static_cast<int>(state.range(0)), n);
+  IndexedGraph indexed(*cache.graph);
+  Partition partition(indexed, static_cast<int>(state.range(2)));
+  ShardedGraph sharded(indexed, partition);
+  std::string error;
+  if (!sharded.start(error)) {
+    state.SkipWithError(error.c_str());
+    return;
+  }
+  std::vector<std::string> sources = randomLabels(n, 16, 5);
+  std::vector<std::string> targets = randomLabels(n, 16, 6);
+  std::vector<std::string> path;
+  uint64_t messages = 0;
+  for (auto _ : state) {
+    messages = 0;
+    for (size_t i = 0; i < sources.size(); ++i) {
+      benchmark::DoNotOptimize(
+          sharded.shortestPath(sources[i], targets[i], path));
+      messages += sharded.getStats().messages;
+    }
+  }
+  reportCounters(state, indexed.getNumEdges());
+  state.counters["messages"] = messages;
+}
+
+// half of the lookups hit an existing edge, the other half miss
+std::vector<std::pair<std::string, std::string>> edgeQueries(
+    const CachedGraph& cache, int n) {
+  std::mt19937 rng(kQuerySeed);
+  std::uniform_int_distribution<size_t> pick(0, cache.edges.size() - 1);
+  std::uniform_int_distribution<int> vertex(0, n - 1);
+  std::vector<std::pair<std::string, std::string>> queries;
+  for (int i = 0; i < 1024; ++i) {
+    const auto& edge = cache.edges[pick(rng)];
+    queries.emplace_back(std::get<0>(edge), std::get<1>(edge));
+    queries.emplace_back(std::to_string(vertex(rng)),
+                         std::to_string(vertex(rng)));
+  }
+  return queries;
+}
+
+/** the same queries as snapshot ids */
+std::vector<std::pair<int, int>> edgeQueryIds(const CachedGraph& cache,
+                                              const IndexedGraph& indexed,
+                                              int n) {
+  std::vector<std::pair<int, int>> ids;
+  for (const auto& query : edgeQueries(cache, n)) {
+    ids.emplace_back(indexed.getId(query.first),
+                     indexed.getId(query.second));
+  }
+  return ids;
+}
+
+static void BM_GetEdgeWeight(benchmark::State& state) {
+  int n = static_cast<int>(state.range(1));
+  CachedGraph& cache = cachedGraph(static_cast<int>(state.range(0)), n);
+  std::vector<std::pair<std::string, std::string>> queries =
+      edgeQueries(cache, n);
+  for (auto _ : state) {
+    for (const auto& query : queries) {
+      benchmark::DoNotOptimize(
+          cache.graph->getEdgeWeight(query.first, query.second));
+    }
+  }
+  reportCounters(state, static_cast<int64_t>(queries.size()));
+}
+
+// IndexedGraph::getEdgeWeights, row scans with prefetching
+static void BM_GetEdgeWeightsBatch(benchmark::State& state) {
+  int n = static_cast<int>(state.range(1));
+  CachedGraph& cache = cachedGraph(static_cast<int>(state.range(0)), n);
+  IndexedGraph indexed(*cache.graph);
+  std::vector<std::pair<int, int>> queries = edgeQueryIds(cache, indexed, n);
+  std::vector<int> weights;
+  for (auto _ : state) {
+    indexed.getEdgeWeights(queries, weights);
+    benchmark::DoNotOptimize(weights.data());
+  }
+  reportCounters(state, static_cast<int64_t>(queries.size()));
+}
+
+// EdgeIndex, the hash of every edge, plus the bit matrix when dense is 1
+// (the matrix covers every vertex, so it is only run on small graphs)
+static void BM_EdgeIndexGetEdgeWeights(benchmark::State& state) {
+  int n = static_cast<int>(state.range(1));
+  CachedGraph& cache = cachedGraph(static_cast<int>(state.range(0)), n);
+  IndexedGraph indexed(*cache.graph);
+  EdgeIndex index(indexed);
+  if (state.range(2) != 0) {
+    std::vector<int> everyone(indexed.getNumVertices());
+    for (int v = 0; v < indexed.getNumVertices(); ++v) {
+      everyone[v] = v;
+    }
+    index.setDenseSubset(everyone);
+  }
+  std::vector<std::pair<int, int>> queries = edgeQueryIds(cache, indexed, n);
+  std::vector<int> weights;
+  for (auto _ : state) {
+    index.getEdgeWeights(queries, weights);
+    benchmark::DoNotOptimize(weights.data());
+  }
+  reportCounters(state, static_cast<int64_t>(queries.size()));
+  state.counters["index_MB"] = index.getBytes() / 1048576.0;
+}
+
+// skewed traffic: 9 in 10 queries start from one of 64 hot sources,
+// every iteration starts from an empty cache
+static void BM_PathCacheGetCost(benchmark::State& state) {
+  int n = static_cast<int>(state.range(1));
+  CachedGraph& cache = cachedGraph(static_cast<int>(state.range(0)), n);
+  std::mt19937 rng(kQuerySeed);
+  std::uniform_int_distribution<int> vertex(0, n - 1);
+  std::uniform_int_distribution<int> hot(0, 63);
+  std::uniform_int_distribution<int> percent(0, 99);
+  std::vector<std::pair<std::string, std::string>> queries;
+  for (int i = 0; i < 4096; ++i) {
+    int source = percent(rng) < 90 ? hot(rng) : vertex(rng);
+    queries.emplace_back(std::to_string(source),
+                         std::to_string(vertex(rng)));
+  }
+  double hits = 0;
+  for (auto _ : state) {
+    PathCache paths(*cache.graph);
+    for (const auto& query : queries) {
+      benchmark::DoNotOptimize(paths.getCost(query.first, query.second));
+    }
+    hits = static_cast<double>(paths.getStats().hits) / queries.size();
+  }
+  reportCounters(state, static_cast<int64_t>(queries.size()));
+  state.counters["hit_rate"] = hits;
+}
+
+// QueryServer answering WEIGHT lines batch requests at a time, without
+// the socket: batch 1 is a server that never coalesces requests
+static void BM_QueryServerWeights(benchmark::State& state) {
+  int n = static_cast<int>(state.range(1));
+  size_t batch = static_cast<size_t>(state.range(2));
+  CachedGraph& cache = cachedGraph(static_cast<int>(state.range(0)), n);
+  ServerOptions options;
+  QueryServer server(*cache.graph, options);
+  std::vector<std::string> lines;
+  for (const auto& query : edgeQueries(cache, n)) {
+    lines.push_back("WEIGHT " + query.first + " " + query.second);
+  }
+  std::vector<std::string> chunk;
+  for (auto _ : state) {
+    for (size_t begin = 0; begin < lines.size(); begin += batch) {
+      chunk.assign(lines.begin() + begin,
+                   lines.begin() + std::min(begin + batch, lines.size()));
+      benchmark::DoNotOptimize(server.handleBatch(chunk).data());
+    }
+  }
+  reportCounters(state, static_cast<int64_t>(lines.size()));
+}
+
+// kind x vertices, vertices grow by 8x from 1K
+static void allKinds(benchmark::internal::Benchmark* b, int64_t maxVertices) {
+  b->ArgNames({"kind", "vertices"});
+  b->ArgsProduct({{kChain, kGrid, kErdosRenyi, kRmat},
+                  benchmark::CreateRange(1 << 10, maxVertices, 8)});
+  b->Unit(benchmark::kMillisecond);
+}
+
+static void upToMax(benchmark::internal::Benchmark* b) {
+  allKinds(b, GRAPH_BENCH_MAX_VERTICES);
+}
+
+static void upToMaxRecursive(benchmark::internal::Benchmark* b) {
+  allKinds(b, GRAPH_BENCH_MAX_RECURSIVE);
+}
+
+static void upToMaxDjikstra(benchmark::internal::Benchmark* b) {
+  allKinds(b, GRAPH_BENCH_MAX_DJIKSTRA);
+}
+
+// kind x vertices x ordering, the snapshot traversals are not recursive
+static void allOrderings(benchmark::internal::Benchmark* b) {
+  b->ArgNames({"kind", "vertices", "ordering"});
+  b->ArgsProduct({{kChain, kGrid, kErdosRenyi, kRmat},
+                  benchmark::CreateRange(1 << 10, GRAPH_BENCH_MAX_VERTICES, 8),
+                  {static_cast<int>(VertexOrdering::Label),
+                   static_cast<int>(VertexOrdering::Degree),
+                   static_cast<int>(VertexOrdering::BreadthFirst),
+                   static_cast<int>(VertexOrdering::ReverseCuthillMcKee)}});
+  b->Unit(benchmark::kMillisecond);
+}
+
+// kind x vertices x dense, the bit matrix is n * n bits
+static void withDenseSubset(benchmark::internal::Benchmark* b) {
+  b->ArgNames({"kind", "vertices", "dense"});
+  b->ArgsProduct({{kChain, kGrid, kErdosRenyi, kRmat},
+                  benchmark::CreateRange(1 << 10, GRAPH_BENCH_MAX_VERTICES, 8),
+                  {0}});
+  b->ArgsProduct({{kChain, kGrid, kErdosRenyi, kRmat},
+                  benchmark::CreateRange(1 << 10, 1 << 13, 8), {1}});
+  b->Unit(benchmark::kMicrosecond);
+}
+
+// kind x vertices x requests per batch
+static void withBatchSize(benchmark::internal::Benchmark* b) {
+  b->ArgNames({"kind", "vertices", "batch"});
+  b->ArgsProduct({{kChain, kGrid, kErdosRenyi, kRmat},
+                  benchmark::CreateRange(1 << 10, GRAPH_BENCH_MAX_VERTICES, 8),
+                  {1, 64}});
+  b->Unit(benchmark::kMicrosecond);
+}
+
+// kind x vertices x worker processes
+static void withShards(benchmark::internal::Benchmark* b) {
+  b->ArgNames({"kind", "vertices", "shards"});
+  b->ArgsProduct({{kChain, kGrid, kErdosRenyi, kRmat},
+                  benchmark::CreateRange(1 << 10, GRAPH_BENCH_MAX_VERTICES, 8),
+                  {1, 2, 4}});
+  b->Unit(benchmark::kMillisecond);
+}
+
+BENCHMARK(BM_Add)->Apply(upToMax);
+BENCHMARK(BM_ReadFile)->Apply(upToMax);
+BENCHMARK(BM_DepthFirstTraversal)->Apply(upToMaxRecursive);
+BENCHMARK(BM_BreadthFirstTraversal)->Apply(upToMax);
+BENCHMARK(BM_DjikstraCostToAllVertices)->Apply(upToMaxDjikstra);
+BENCHMARK(BM_IndexedBreadthFirstTraversal)->Apply(allOrderings);
+BENCHMARK(BM_IndexedDepthFirstTraversal)->Apply(allOrderings);
+BENCHMARK(BM_CompressedBreadthFirstTraversal)->Apply(allOrderings);
+BENCHMARK(BM_PageRankIteration)->Apply(allOrderings);
+BENCHMARK(BM_SpanningForest)->Apply(upToMax);
+BENCHMARK(BM_ExternalBreadthFirstSearch)->Apply(upToMax);
+BENCHMARK(BM_GetEdgeWeight)->Apply(upToMax)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_GetEdgeWeightsBatch)
+    ->Apply(upToMax)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_EdgeIndexGetEdgeWeights)->Apply(withDenseSubset);
+BENCHMARK(BM_PathCacheGetCost)->Apply(upToMaxDjikstra);
+BENCHMARK(BM_DistanceTable)->Apply(upToMax);
+BENCHMARK(BM_KShortestPaths)->Apply(upToMaxDjikstra);
+BENCHMARK(BM_QueryServerWeights)->Apply(withBatchSize);
+BENCHMARK(BM_Partition)->Apply(upToMax);
+BENCHMARK(BM_ShardedBreadthFirstSearch)->Apply(withShards);
+BENCHMARK(BM_ShardedShortestPath)->Apply(withShards);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,144 @@
+#include "blockreader.h"
+
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////
+// This is 80 characters - Keep all lines under 80 characters                 //
+////////////////////////////////////////////////////////////////////////////////
+
+/** open path for reading, blocks are cut every blockBytes, so a
+    multiple of the record size keeps records whole */
+BlockReader::BlockReader(const std::string& path, size_t blockBytes,
+                         int depth)
+    : file(path, std::ios::in | std::ios::binary),
+      blockBytes(std::max<size_t>(1, blockBytes)) {
+  for (int b = 0; b < std::max(1, depth); ++b) {
+    spare.push_back(Block {std::vector<char>(this->blockBytes), 0, 0});
+  }
+  worker = std::thread(&BlockReader::run, this);
+}
+
+/** stops the I/O thread */
+BlockReader::~BlockReader() {
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    stopping = true;
+  }
+  changed.notify_all();
+  worker.join();
+}
+
+/** return true if the file opened */
+bool BlockReader::isOpen() const { return file.is_open(); }
+
+/** read these extents in order, dropping whatever was scheduled and
+    not yet taken */
+void BlockReader::schedule(const std::vector<Extent>& extents) {
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    generation++;
+    this->extents = extents;
+    nextExtent = 0;
+    doneInExtent = 0;
+    shortRead = false;
+    while (!filled.empty()) {
+      spare.push_back(std::move(filled.front()));
+      filled.pop_front();
+    }
+    if (holding) {
+      spare.push_back(std::move(current));
+      holding = false;
+    }
+  }
+  changed.notify_all();
+}
+
+/** the next block of the schedule
+    data stays valid until the next call
+    @return  false once every extent has been taken, or a read failed */
+bool BlockReader::next(const char*& data, size_t& bytes, uint64_t& offset) {
+  std::unique_lock<std::mutex> guard(lock);
+  if (holding) {
+    spare.push_back(std::move(current));
+    holding = false;
+    changed.notify_all();
+  }
+  changed.wait(guard, [this] {
+    return !filled.empty() || shortRead ||
+           (!reading && nextExtent == extents.size());
+  });
+  if (filled.empty()) {
+    return false;
+  }
+  current = std::move(filled.front());
+  filled.pop_front();
+  holding = true;
+  changed.notify_all();
+  data = current.data.data();
+  bytes = current.bytes;
+  offset = current.offset;
+  return true;
+}
+
+/** return true if a read came up short */
+bool BlockReader::failed() const {
+  std::lock_guard<std::mutex> guard(lock);
+  return shortRead;
+}
+
+/** return bytes read from the file so far */
+uint64_t BlockReader::getBytesRead() const {
+  std::lock_guard<std::mutex> guard(lock);
+  return bytesRead;
+}
+
+/** I/O thread loop */
+void BlockReader::run() {
+  std::unique_lock<std::mutex> guard(lock);
+  for (;;) {
+    changed.wait(guard, [this] {
+      return stopping ||
+             (!shortRead && nextExtent < extents.size() && !spare.empty());
+    });
+    if (stopping) {
+      return;
+    }
+
+    // claim the next piece, then read it without holding the lock
+    Block block = std::move(spare.back());
+    spare.pop_back();
+    const Extent& extent = extents[nextExtent];
+    block.offset = extent.offset + doneInExtent;
+    block.bytes = static_cast<size_t>(
+        std::min<uint64_t>(blockBytes, extent.bytes - doneInExtent));
+    doneInExtent += block.bytes;
+    if (doneInExtent == extent.bytes) {
+      nextExtent++;
+      doneInExtent = 0;
+    }
+    uint64_t readFor = generation;
+    reading = true;
+    guard.unlock();
+
+    file.clear();
+    file.seekg(static_cast<std::streamoff>(block.offset));
+    file.read(block.data.data(), static_cast<std::streamsize>(block.bytes));
+    bool whole = static_cast<size_t>(file.gcount()) == block.bytes;
+
+    guard.lock();
+    reading = false;
+    bytesRead += file.gcount();
+    if (readFor != generation) {
+      spare.push_back(std::move(block));
+    } else if (!whole) {
+      shortRead = true;
+      spare.push_back(std::move(block));
+    } else {
+      filled.push_back(std::move(block));
+    }
+    changed.notify_all();
+  }
+}
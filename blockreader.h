@@ -0,0 +1,98 @@
+/**
+ * Reads pieces of a file on a background thread
+ * The caller lists the byte ranges it wants, in the order it wants them,
+ * and takes them back as blocks of at most blockBytes. The I/O thread
+ * keeps up to depth blocks read ahead, so the disk works on the next block
+ * while the caller processes this one. Ranges in increasing file order
+ * make the reads sequential.
+ */
+
+#ifndef BLOCKREADER_H
+#define BLOCKREADER_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class BlockReader {
+ public:
+    /** bytes to read starting at offset */
+    struct Extent {
+      uint64_t offset;
+      uint64_t bytes;
+    };
+
+    /** open path for reading, blocks are cut every blockBytes, so a
+        multiple of the record size keeps records whole */
+    explicit BlockReader(const std::string& path,
+                         size_t blockBytes = size_t(4) << 20,
+                         int depth = 4);
+
+    /** stops the I/O thread */
+    ~BlockReader();
+
+    /** return true if the file opened */
+    bool isOpen() const;
+
+    /** read these extents in order, dropping whatever was scheduled and
+        not yet taken */
+    void schedule(const std::vector<Extent>& extents);
+
+    /** the next block of the schedule
+        data stays valid until the next call
+        @return  false once every extent has been taken, or a read failed */
+    bool next(const char*& data, size_t& bytes, uint64_t& offset);
+
+    /** return true if a read came up short */
+    bool failed() const;
+
+    /** return bytes read from the file so far */
+    uint64_t getBytesRead() const;
+
+ private:
+    struct Block {
+      std::vector<char> data;
+      size_t bytes;
+      uint64_t offset;
+    };
+
+    std::ifstream file;
+    size_t blockBytes;
+
+    /** guards everything below */
+    mutable std::mutex lock;
+    std::condition_variable changed;
+
+    std::vector<Extent> extents;
+    size_t nextExtent {0};
+    uint64_t doneInExtent {0};
+
+    /** bumped by schedule, so a read finished for an old schedule is
+        dropped */
+    uint64_t generation {0};
+    bool reading {false};
+
+    std::deque<Block> filled;
+    std::vector<Block> spare;
+
+    /** the block next handed out last */
+    Block current;
+    bool holding {false};
+
+    bool shortRead {false};
+    bool stopping {false};
+    uint64_t bytesRead {0};
+
+    std::thread worker;
+
+    /** I/O thread loop */
+    void run();
+};
+
+#endif  // BLOCKREADER_H
@@ -0,0 +1,312 @@
+#include "centrality.h"
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+#include <algorithm>
+#include <cmath>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////
+// This is 80 characters - Keep all lines under 80 characters                 //
+////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+#ifdef __AVX2__
+/** contribution[index[0 .. 3]], the masked form with a zero source
+    keeps gcc from warning about the unmasked form's undefined source */
+inline __m256d gather(const double* contribution, __m128i index) {
+  return _mm256_mask_i32gather_pd(_mm256_setzero_pd(), contribution, index,
+                                  _mm256_castsi256_pd(_mm256_set1_epi64x(-1)),
+                                  8);
+}
+#endif
+
+/** sum of contribution[sources[0 .. count - 1]] */
+double sumContributions(const double* contribution, const int* sources,
+                        int count) {
+  int i = 0;
+  double sum = 0;
+#ifdef __AVX2__
+  // two accumulators so consecutive gathers do not wait on one add
+  __m256d even = _mm256_setzero_pd();
+  __m256d odd = _mm256_setzero_pd();
+  for (; i + 8 <= count; i += 8) {
+    __m128i low = _mm_loadu_si128(
+        reinterpret_cast<const __m128i*>(sources + i));
+    __m128i high = _mm_loadu_si128(
+        reinterpret_cast<const __m128i*>(sources + i + 4));
+    even = _mm256_add_pd(even, gather(contribution, low));
+    odd = _mm256_add_pd(odd, gather(contribution, high));
+  }
+  if (i + 4 <= count) {
+    __m128i low = _mm_loadu_si128(
+        reinterpret_cast<const __m128i*>(sources + i));
+    even = _mm256_add_pd(even, gather(contribution, low));
+    i += 4;
+  }
+  double lanes[4];
+  _mm256_storeu_pd(lanes, _mm256_add_pd(even, odd));
+  sum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#endif
+  for (; i < count; ++i) {
+    sum += contribution[sources[i]];
+  }
+  return sum;
+}
+
+/** what one thread adds up over its range in an iteration */
+struct RangeTotals {
+  double change {0};    // L1 distance from the previous scores
+  double dangling {0};  // new score held by vertices without out edges
+};
+
+}  // namespace
+
+/** build the in-edge array of graph
+    threads is the number of PageRank workers, 0 picks one per core */
+template <typename Label, typename Weight>
+BasicCentrality<Label, Weight>::BasicCentrality(
+    const BasicIndexedGraph<Label, Weight>& graph, int threads)
+    : graph(graph), threads(threads) {
+  int n = graph.getNumVertices();
+  if (this->threads <= 0) {
+    this->threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  this->threads = std::max(1, std::min(this->threads, n));
+
+  // count, prefix sum, then fill, like undirectedAdjacency
+  inStart.assign(n + 1, 0);
+  outDegree.assign(n, 0);
+  std::vector<int> neighbors;
+  for (int v = 0; v < n; ++v) {
+    neighbors.clear();
+    graph.getNeighbors(v, neighbors);
+    outDegree[v] = static_cast<int>(neighbors.size());
+    for (int w : neighbors) {
+      ++inStart[w + 1];
+    }
+  }
+  for (int v = 0; v < n; ++v) {
+    inStart[v + 1] += inStart[v];
+  }
+  sources.resize(inStart[n]);
+  std::vector<int> fill(inStart.begin(), inStart.end() - 1);
+  for (int v = 0; v < n; ++v) {
+    neighbors.clear();
+    graph.getNeighbors(v, neighbors);
+    for (int w : neighbors) {
+      sources[fill[w]++] = v;
+    }
+  }
+
+  // split by in-edges plus one per vertex, so a hub does not leave
+  // one thread with most of the work
+  ranges.assign(1, 0);
+  long long work = static_cast<long long>(inStart[n]) + n;
+  for (int t = 1; t < this->threads; ++t) {
+    long long target = work * t / this->threads;
+    int low = ranges.back();
+    int high = n;
+    while (low < high) {
+      int mid = low + (high - low) / 2;
+      if (static_cast<long long>(inStart[mid]) + mid < target) {
+        low = mid + 1;
+      } else {
+        high = mid;
+      }
+    }
+    ranges.push_back(low);
+  }
+  ranges.push_back(n);
+}
+
+/** run PageRank until the scores move less than tolerance in total
+    (L1 distance between iterations) or maxIterations have run
+    vertices without out edges share their score with every vertex
+    @return  the number of iterations run */
+template <typename Label, typename Weight>
+int BasicCentrality<Label, Weight>::pageRank(double damping,
+                                             double tolerance,
+                                             int maxIterations) {
+  int n = graph.getNumVertices();
+  if (n == 0) {
+    ranks.clear();
+    return 0;
+  }
+  ranks.assign(n, 1.0 / n);
+  std::vector<double> next(n);
+
+  // contribution[u] is what u passes along each out edge,
+  // kept apart from ranks so the inner loop is one gather and one add
+  std::vector<double> contribution(n);
+  std::vector<double> nextContribution(n);
+  double dangling = 0;
+  for (int v = 0; v < n; ++v) {
+    if (outDegree[v] == 0) {
+      dangling += ranks[v];
+    } else {
+      contribution[v] = ranks[v] / outDegree[v];
+    }
+  }
+
+  // the ranges were split once in the constructor; the workers start once
+  // here and wait on round between iterations instead of being respawned
+  int workers = static_cast<int>(ranges.size()) - 1;
+  std::vector<RangeTotals> totals(workers);
+  double base = 0;
+  auto update = [&](int t) {
+    RangeTotals sum;
+    for (int v = ranges[t]; v < ranges[t + 1]; ++v) {
+      double score = base + damping * sumContributions(
+                                contribution.data(),
+                                sources.data() + inStart[v],
+                                inStart[v + 1] - inStart[v]);
+      sum.change += std::fabs(score - ranks[v]);
+      next[v] = score;
+      if (outDegree[v] == 0) {
+        sum.dangling += score;
+        nextContribution[v] = 0;
+      } else {
+        nextContribution[v] = score / outDegree[v];
+      }
+    }
+    totals[t] = sum;
+  };
+
+  // round counts the iterations handed out, running the workers still
+  // busy with the current one; the lock orders the swaps below against
+  // the reads in update
+  std::mutex lock;
+  std::condition_variable started;
+  std::condition_variable finished;
+  long long round = 0;
+  int running = 0;
+  bool stopping = false;
+  std::vector<std::thread> pool;
+  for (int t = 1; t < workers; ++t) {
+    pool.emplace_back([&, t]() {
+      long long seen = 0;
+      while (true) {
+        {
+          std::unique_lock<std::mutex> guard(lock);
+          started.wait(guard, [&]() { return stopping || round != seen; });
+          if (stopping) {
+            return;
+          }
+          seen = round;
+        }
+        update(t);
+        {
+          std::lock_guard<std::mutex> guard(lock);
+          if (--running == 0) {
+            finished.notify_one();
+          }
+        }
+      }
+    });
+  }
+
+  int iteration = 0;
+  while (iteration < maxIterations) {
+    ++iteration;
+    base = (1 - damping) / n + damping * dangling / n;
+    {
+      std::lock_guard<std::mutex> guard(lock);
+      running = workers - 1;
+      ++round;
+    }
+    started.notify_all();
+    update(0);
+    {
+      std::unique_lock<std::mutex> guard(lock);
+      finished.wait(guard, [&]() { return running == 0; });
+    }
+
+    double change = 0;
+    dangling = 0;
+    for (const RangeTotals& sum : totals) {
+      change += sum.change;
+      dangling += sum.dangling;
+    }
+    ranks.swap(next);
+    contribution.swap(nextContribution);
+    if (change < tolerance) {
+      break;
+    }
+  }
+
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    stopping = true;
+  }
+  started.notify_all();
+  for (std::thread& worker : pool) {
+    worker.join();
+  }
+  return iteration;
+}
+
+/** return the PageRank of label, 0 before pageRank or if no such vertex
+    the scores of all vertices add up to 1 */
+template <typename Label, typename Weight>
+double BasicCentrality<Label, Weight>::getPageRank(const Label& label) const {
+  int id = graph.getId(label);
+  if (id < 0 || ranks.empty()) {
+    return 0;
+  }
+  return ranks[id];
+}
+
+/** PageRank of every vertex, indexed by IndexedGraph id */
+template <typename Label, typename Weight>
+const std::vector<double>&
+BasicCentrality<Label, Weight>::getPageRanks() const {
+  return ranks;
+}
+
+/** return number of edges into label, -1 if there is no such vertex */
+template <typename Label, typename Weight>
+int BasicCentrality<Label, Weight>::getInDegree(const Label& label) const {
+  int id = graph.getId(label);
+  return id < 0 ? -1 : inStart[id + 1] - inStart[id];
+}
+
+/** return number of edges out of label, -1 if there is no such vertex */
+template <typename Label, typename Weight>
+int BasicCentrality<Label, Weight>::getOutDegree(const Label& label) const {
+  int id = graph.getId(label);
+  return id < 0 ? -1 : outDegree[id];
+}
+
+/** return (in + out degree) / (vertices - 1), -1 if no such vertex */
+template <typename Label, typename Weight>
+double BasicCentrality<Label, Weight>::getDegreeCentrality(
+    const Label& label) const {
+  int id = graph.getId(label);
+  if (id < 0) {
+    return -1;
+  }
+  int n = graph.getNumVertices();
+  if (n < 2) {
+    return 0;
+  }
+  return static_cast<double>(inStart[id + 1] - inStart[id] + outDegree[id]) /
+         (n - 1);
+}
+
+// same label and weight types as BasicGraph
+template class BasicCentrality<std::string, int>;
+template class BasicCentrality<std::string, long long>;
+template class BasicCentrality<std::string, double>;
+template class BasicCentrality<std::string, Unweighted>;
+template class BasicCentrality<int, int>;
+template class BasicCentrality<int, long long>;
+template class BasicCentrality<int, double>;
+template class BasicCentrality<int, Unweighted>;
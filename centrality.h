@@ -0,0 +1,74 @@
+/**
+ * PageRank and degree centrality of an IndexedGraph
+ * The constructor turns the snapshot around into an in-edge array, so each
+ * PageRank iteration pulls: every vertex sums the contributions of the
+ * vertices pointing at it and writes only its own score. No two threads
+ * ever write the same entry, so the vertex range is split between threads
+ * without locks, each thread taking about the same number of in-edges.
+ * The split is made once by the constructor, and pageRank starts its
+ * threads once and holds them at a condition variable between iterations.
+ *
+ * Build with -mavx2 (or -march=native) to gather four contributions per
+ * instruction; otherwise the sums are scalar. Edge costs are ignored.
+ */
+
+#ifndef CENTRALITY_H
+#define CENTRALITY_H
+
+#include <string>
+#include <vector>
+
+#include "indexedgraph.h"
+
+template <typename Label, typename Weight>
+class BasicCentrality {
+ public:
+    /** build the in-edge array of graph
+        threads is the number of PageRank workers, 0 picks one per core */
+    explicit BasicCentrality(const BasicIndexedGraph<Label, Weight>& graph,
+                             int threads = 0);
+
+    /** run PageRank until the scores move less than tolerance in total
+        (L1 distance between iterations) or maxIterations have run
+        vertices without out edges share their score with every vertex
+        @return  the number of iterations run */
+    int pageRank(double damping = 0.85, double tolerance = 1e-6,
+                 int maxIterations = 100);
+
+    /** return the PageRank of label, 0 before pageRank or if no such vertex
+        the scores of all vertices add up to 1 */
+    double getPageRank(const Label& label) const;
+
+    /** PageRank of every vertex, indexed by IndexedGraph id */
+    const std::vector<double>& getPageRanks() const;
+
+    /** return number of edges into label, -1 if there is no such vertex */
+    int getInDegree(const Label& label) const;
+
+    /** return number of edges out of label, -1 if there is no such vertex */
+    int getOutDegree(const Label& label) const;
+
+    /** return (in + out degree) / (vertices - 1), -1 if no such vertex */
+    double getDegreeCentrality(const Label& label) const;
+
+ private:
+    const BasicIndexedGraph<Label, Weight>& graph;
+
+    int threads;
+
+    /** edges into v come from sources[inStart[v]] .. [inStart[v + 1] - 1] */
+    std::vector<int> inStart;
+    std::vector<int> sources;
+
+    std::vector<int> outDegree;
+
+    std::vector<double> ranks;
+
+    /** first vertex of each thread's range, plus one past the end */
+    std::vector<int> ranges;
+};
+
+/** centrality of the assignment's Graph */
+typedef BasicCentrality<std::string, int> Centrality;
+
+#endif  // CENTRALITY_H
@@ -0,0 +1,220 @@
+#include "components.h"
+
+#include <algorithm>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "unionfind.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// This is 80 characters - Keep all lines under 80 characters                 //
+////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+/** replace representatives with dense ids in order of first appearance */
+int renumber(std::vector<int>& component) {
+  std::vector<int> dense(component.size(), -1);
+  int count = 0;
+  for (int& c : component) {
+    if (dense[c] < 0) {
+      dense[c] = count++;
+    }
+    c = dense[c];
+  }
+  return count;
+}
+
+}  // namespace
+
+/** find both kinds of component
+    threads is the number of union-find workers, 0 picks one per core */
+template <typename Label, typename Weight>
+BasicComponents<Label, Weight>::BasicComponents(
+    const BasicIndexedGraph<Label, Weight>& graph, int threads)
+    : graph(graph) {
+  findWeakComponents(threads);
+  findStrongComponents();
+}
+
+/** return number of weakly connected components */
+template <typename Label, typename Weight>
+int BasicComponents<Label, Weight>::getNumWeakComponents() const {
+  return weakCount;
+}
+
+/** return number of strongly connected components */
+template <typename Label, typename Weight>
+int BasicComponents<Label, Weight>::getNumStrongComponents() const {
+  return strongCount;
+}
+
+/** return the weak component of label, -1 if there is no such vertex */
+template <typename Label, typename Weight>
+int BasicComponents<Label, Weight>::getWeakComponent(
+    const Label& label) const {
+  int id = graph.getId(label);
+  return id < 0 ? -1 : weak[id];
+}
+
+/** return the strong component of label, -1 if there is no such vertex */
+template <typename Label, typename Weight>
+int BasicComponents<Label, Weight>::getStrongComponent(
+    const Label& label) const {
+  int id = graph.getId(label);
+  return id < 0 ? -1 : strong[id];
+}
+
+/** weak component of every vertex, indexed by IndexedGraph id */
+template <typename Label, typename Weight>
+const std::vector<int>&
+BasicComponents<Label, Weight>::getWeakComponents() const {
+  return weak;
+}
+
+/** strong component of every vertex, indexed by IndexedGraph id */
+template <typename Label, typename Weight>
+const std::vector<int>&
+BasicComponents<Label, Weight>::getStrongComponents() const {
+  return strong;
+}
+
+/** return true if there cannot be a path from start to end
+    (different weak components, or a label that does not exist)
+    false only means a path may exist */
+template <typename Label, typename Weight>
+bool BasicComponents<Label, Weight>::isUnreachable(const Label& start,
+                                                   const Label& end) const {
+  int from = getWeakComponent(start);
+  int to = getWeakComponent(end);
+  return from < 0 || to < 0 || from != to;
+}
+
+/** return true if start and end reach each other */
+template <typename Label, typename Weight>
+bool BasicComponents<Label, Weight>::isMutuallyReachable(
+    const Label& start, const Label& end) const {
+  int from = getStrongComponent(start);
+  return from >= 0 && from == getStrongComponent(end);
+}
+
+template <typename Label, typename Weight>
+void BasicComponents<Label, Weight>::findWeakComponents(int threads) {
+  int n = graph.getNumVertices();
+  if (threads <= 0) {
+    threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  threads = std::max(1, std::min(threads, n));
+
+  ConcurrentUnionFind sets(n);
+
+  // each worker links the edges leaving its slice of the ids
+  auto link = [this, &sets](int begin, int end) {
+    std::vector<int> neighbors;
+    for (int v = begin; v < end; ++v) {
+      neighbors.clear();
+      graph.getNeighbors(v, neighbors);
+      for (int next : neighbors) {
+        sets.unite(v, next);
+      }
+    }
+  };
+  std::vector<std::thread> workers;
+  int slice = (n + threads - 1) / std::max(1, threads);
+  for (int t = 1; t < threads; ++t) {
+    workers.emplace_back(link, std::min(n, t * slice),
+                         std::min(n, (t + 1) * slice));
+  }
+  link(0, std::min(n, slice));
+  for (std::thread& worker : workers) {
+    worker.join();
+  }
+
+  weak.resize(n);
+  for (int v = 0; v < n; ++v) {
+    weak[v] = sets.find(v);
+  }
+  weakCount = renumber(weak);
+}
+
+/** Tarjan's algorithm with an explicit call stack */
+template <typename Label, typename Weight>
+void BasicComponents<Label, Weight>::findStrongComponents() {
+  int n = graph.getNumVertices();
+  std::vector<int> index(n, -1);
+  std::vector<int> lowLink(n, 0);
+  std::vector<char> onStack(n, 0);
+  std::vector<int> tarjanStack;
+  strong.assign(n, -1);
+
+  // like DepthFirstTraversal, rows holds the neighbors of every vertex on
+  // the call stack and each frame is (vertex, start of row, next neighbor)
+  struct Frame {
+    int vertex;
+    size_t row;
+    size_t next;
+  };
+  std::vector<Frame> calls;
+  std::vector<int> rows;
+  int nextIndex = 0;
+
+  for (int root = 0; root < n; ++root) {
+    if (index[root] >= 0) {
+      continue;
+    }
+    index[root] = lowLink[root] = nextIndex++;
+    tarjanStack.push_back(root);
+    onStack[root] = 1;
+    graph.getNeighbors(root, rows);
+    calls.push_back(Frame {root, 0, 0});
+
+    while (!calls.empty()) {
+      Frame& top = calls.back();
+      int v = top.vertex;
+      if (top.next < rows.size()) {
+        int w = rows[top.next++];
+        if (index[w] < 0) {
+          // "recurse" into w
+          index[w] = lowLink[w] = nextIndex++;
+          tarjanStack.push_back(w);
+          onStack[w] = 1;
+          size_t row = rows.size();
+          graph.getNeighbors(w, rows);
+          calls.push_back(Frame {w, row, row});
+        } else if (onStack[w]) {
+          lowLink[v] = std::min(lowLink[v], index[w]);
+        }
+        continue;
+      }
+
+      // every neighbor done, v roots a component if nothing reached lower
+      if (lowLink[v] == index[v]) {
+        int w;
+        do {
+          w = tarjanStack.back();
+          tarjanStack.pop_back();
+          onStack[w] = 0;
+          strong[w] = v;
+        } while (w != v);
+      }
+      rows.resize(top.row);
+      calls.pop_back();
+      if (!calls.empty()) {
+        int parent = calls.back().vertex;
+        lowLink[parent] = std::min(lowLink[parent], lowLink[v]);
+      }
+    }
+  }
+  strongCount = renumber(strong);
+}
+
+// same label and weight types as BasicGraph
+template class BasicComponents<std::string, int>;
+template class BasicComponents<std::string, long long>;
+template class BasicComponents<std::string, double>;
+template class BasicComponents<std::string, Unweighted>;
+template class BasicComponents<int, int>;
+template class BasicComponents<int, long long>;
+template class BasicComponents<int, double>;
+template class BasicComponents<int, Unweighted>;
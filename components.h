@@ -0,0 +1,71 @@
+/**
+ * Weakly and strongly connected components of an IndexedGraph
+ * Weak components come from a lock-free union-find shared by several
+ * threads, each thread linking the edges of its own range of vertices.
+ * Strong components come from an iterative Tarjan, so long chains do not
+ * overflow the call stack.
+ *
+ * Component ids are dense, 0 .. count - 1, numbered in order of the lowest
+ * vertex id they contain. Two vertices in different weak components can
+ * never reach each other, which answers "no connection" in O(1).
+ */
+
+#ifndef COMPONENTS_H
+#define COMPONENTS_H
+
+#include <string>
+#include <vector>
+
+#include "indexedgraph.h"
+
+template <typename Label, typename Weight>
+class BasicComponents {
+ public:
+    /** find both kinds of component
+        threads is the number of union-find workers, 0 picks one per core */
+    explicit BasicComponents(const BasicIndexedGraph<Label, Weight>& graph,
+                             int threads = 0);
+
+    /** return number of weakly connected components */
+    int getNumWeakComponents() const;
+
+    /** return number of strongly connected components */
+    int getNumStrongComponents() const;
+
+    /** return the weak component of label, -1 if there is no such vertex */
+    int getWeakComponent(const Label& label) const;
+
+    /** return the strong component of label, -1 if there is no such vertex */
+    int getStrongComponent(const Label& label) const;
+
+    /** weak component of every vertex, indexed by IndexedGraph id */
+    const std::vector<int>& getWeakComponents() const;
+
+    /** strong component of every vertex, indexed by IndexedGraph id */
+    const std::vector<int>& getStrongComponents() const;
+
+    /** return true if there cannot be a path from start to end
+        (different weak components, or a label that does not exist)
+        false only means a path may exist */
+    bool isUnreachable(const Label& start, const Label& end) const;
+
+    /** return true if start and end reach each other */
+    bool isMutuallyReachable(const Label& start, const Label& end) const;
+
+ private:
+    const BasicIndexedGraph<Label, Weight>& graph;
+
+    std::vector<int> weak;
+    int weakCount {0};
+
+    std::vector<int> strong;
+    int strongCount {0};
+
+    void findWeakComponents(int threads);
+    void findStrongComponents();
+};
+
+/** components of the assignment's Graph */
+typedef BasicComponents<std::string, int> Components;
+
+#endif  // COMPONENTS_H
@@ -0,0 +1,199 @@
+#include "distancetable.h"
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////
+// This is 80 characters - Keep all lines under 80 characters                 //
+////////////////////////////////////////////////////////////////////////////////
+
+/** copy the edges of graph both ways round into flat arrays
+    threads is the number of searches run at once, 0 picks one per
+    core; graph must outlive the table */
+template <typename Label, typename Weight>
+BasicDistanceTable<Label, Weight>::BasicDistanceTable(
+    const BasicIndexedGraph<Label, Weight>& graph, int threads)
+    : graph(graph), threads(threads) {
+  if (this->threads <= 0) {
+    this->threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  int n = graph.getNumVertices();
+  forwardStart.assign(n + 1, 0);
+  backwardStart.assign(n + 1, 0);
+  for (int v = 0; v < n; ++v) {
+    graph.getNeighbors(v, forwardTo, &forwardCost);
+    forwardStart[v + 1] = static_cast<int>(forwardTo.size());
+  }
+
+  // count the in-edges of each vertex, then place them
+  for (int w : forwardTo) {
+    backwardStart[w + 1]++;
+  }
+  for (int v = 0; v < n; ++v) {
+    backwardStart[v + 1] += backwardStart[v];
+  }
+  backwardFrom.resize(forwardTo.size());
+  backwardCost.resize(forwardTo.size());
+  std::vector<int> next(backwardStart.begin(), backwardStart.end() - 1);
+  for (int v = 0; v < n; ++v) {
+    for (int e = forwardStart[v]; e < forwardStart[v + 1]; ++e) {
+      int slot = next[forwardTo[e]]++;
+      backwardFrom[slot] = v;
+      backwardCost[slot] = forwardCost[e];
+    }
+  }
+}
+
+/** fill the table with the cheapest cost from every source to every
+    target, WeightTraits<Weight>::infinity() where there is no path
+    or either label is missing */
+template <typename Label, typename Weight>
+void BasicDistanceTable<Label, Weight>::compute(
+    const std::vector<Label>& sources, const std::vector<Label>& targets) {
+  const Cost infinity = WeightTraits<Weight>::infinity();
+  int n = graph.getNumVertices();
+  sourceCount = sources.size();
+  targetCount = targets.size();
+  costs.assign(sourceCount * targetCount, infinity);
+  settled = 0;
+
+  // search from the smaller side, backwards when that is the targets
+  bool backward = targetCount < sourceCount;
+  const std::vector<Label>& origins = backward ? targets : sources;
+  const std::vector<Label>& wanted = backward ? sources : targets;
+  const std::vector<int>& start = backward ? backwardStart : forwardStart;
+  const std::vector<int>& to = backward ? backwardFrom : forwardTo;
+  const std::vector<Cost>& cost = backward ? backwardCost : forwardCost;
+
+  // the positions in wanted of each vertex, chained as labels may repeat
+  std::vector<int> firstWanted(n, -1);
+  std::vector<int> nextWanted(wanted.size(), -1);
+  int distinct = 0;
+  for (size_t i = 0; i < wanted.size(); ++i) {
+    int id = graph.getId(wanted[i]);
+    if (id < 0) {
+      continue;
+    }
+    distinct += firstWanted[id] < 0 ? 1 : 0;
+    nextWanted[i] = firstWanted[id];
+    firstWanted[id] = static_cast<int>(i);
+  }
+
+  std::atomic<size_t> nextOrigin(0);
+  std::atomic<uint64_t> settledTotal(0);
+  auto work = [&]() {
+    // (cost so far, id) min heap, stale entries are skipped when popped
+    typedef std::pair<Cost, int> Entry;
+    std::vector<Entry> heap;
+    std::vector<Cost> distance(n, infinity);
+    std::vector<int> touched;
+    uint64_t count = 0;
+    for (size_t r = nextOrigin++; r < origins.size(); r = nextOrigin++) {
+      int origin = graph.getId(origins[r]);
+      if (origin < 0) {
+        continue;
+      }
+      int remaining = distinct;
+      distance[origin] = Cost();
+      touched.push_back(origin);
+      heap.push_back(Entry(Cost(), origin));
+      while (!heap.empty() && remaining > 0) {
+        std::pop_heap(heap.begin(), heap.end(), std::greater<Entry>());
+        Entry top = heap.back();
+        heap.pop_back();
+        int v = top.second;
+        if (distance[v] < top.first) {
+          continue;
+        }
+        count++;
+        if (firstWanted[v] >= 0) {
+          remaining--;
+          for (int c = firstWanted[v]; c >= 0; c = nextWanted[c]) {
+            size_t row = backward ? c : r;
+            size_t column = backward ? r : c;
+            costs[row * targetCount + column] = top.first;
+          }
+        }
+        for (int e = start[v]; e < start[v + 1]; ++e) {
+          Cost through = top.first + cost[e];
+          int w = to[e];
+          if (through < distance[w]) {
+            if (distance[w] == infinity) {
+              touched.push_back(w);
+            }
+            distance[w] = through;
+            heap.push_back(Entry(through, w));
+            std::push_heap(heap.begin(), heap.end(), std::greater<Entry>());
+          }
+        }
+      }
+      for (int v : touched) {
+        distance[v] = infinity;
+      }
+      touched.clear();
+      heap.clear();
+    }
+    settledTotal += count;
+  };
+
+  int workers = static_cast<int>(
+      std::min<size_t>(threads, std::max<size_t>(1, origins.size())));
+  std::vector<std::thread> pool;
+  for (int t = 1; t < workers; ++t) {
+    pool.emplace_back(work);
+  }
+  work();
+  for (std::thread& thread : pool) {
+    thread.join();
+  }
+  settled = settledTotal;
+}
+
+/** return the cost from sources[source] to targets[target] */
+template <typename Label, typename Weight>
+typename BasicDistanceTable<Label, Weight>::Cost
+BasicDistanceTable<Label, Weight>::getCost(size_t source,
+                                           size_t target) const {
+  return costs[source * targetCount + target];
+}
+
+/** every cost, row major: source * getNumTargets() + target */
+template <typename Label, typename Weight>
+const std::vector<typename BasicDistanceTable<Label, Weight>::Cost>&
+BasicDistanceTable<Label, Weight>::getCosts() const {
+  return costs;
+}
+
+/** return number of sources of the last compute */
+template <typename Label, typename Weight>
+size_t BasicDistanceTable<Label, Weight>::getNumSources() const {
+  return sourceCount;
+}
+
+/** return number of targets of the last compute */
+template <typename Label, typename Weight>
+size_t BasicDistanceTable<Label, Weight>::getNumTargets() const {
+  return targetCount;
+}
+
+/** return vertices settled by all searches of the last compute,
+    at most min(sources, targets) times the number of vertices */
+template <typename Label, typename Weight>
+uint64_t BasicDistanceTable<Label, Weight>::getSettled() const {
+  return settled;
+}
+
+// same label and weight types as BasicGraph
+template class BasicDistanceTable<std::string, int>;
+template class BasicDistanceTable<std::string, long long>;
+template class BasicDistanceTable<std::string, double>;
+template class BasicDistanceTable<std::string, Unweighted>;
+template class BasicDistanceTable<int, int>;
+template class BasicDistanceTable<int, long long>;
+template class BasicDistanceTable<int, double>;
+template class BasicDistanceTable<int, Unweighted>;
@@ -0,0 +1,85 @@
+/**
+ * Many-to-many shortest path costs over an IndexedGraph
+ * compute(sources, targets) fills a flat sources x targets matrix, row
+ * major, with the cheapest cost from every source to every target.
+ *
+ * Each row (or column) is one Djikstra, stopped as soon as every vertex it
+ * is looking for has been settled. When there are fewer targets than
+ * sources the searches run backwards from the targets over the reversed
+ * edges, so the number of searches is min(sources, targets). Searches are
+ * independent, so threads take them one at a time, and each thread resets
+ * only the entries its last search touched.
+ *
+ * The bucket method for many-to-many tables only pays off on top of a
+ * contraction hierarchy, where every search settles a few hundred
+ * vertices; over a plain graph each bucket search is a full Djikstra too,
+ * so the searches here are plain ones from the smaller side.
+ */
+
+#ifndef DISTANCETABLE_H
+#define DISTANCETABLE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "indexedgraph.h"
+
+template <typename Label, typename Weight>
+class BasicDistanceTable {
+ public:
+    typedef typename WeightTraits<Weight>::Cost Cost;
+
+    /** copy the edges of graph both ways round into flat arrays
+        threads is the number of searches run at once, 0 picks one per
+        core; graph must outlive the table */
+    explicit BasicDistanceTable(const BasicIndexedGraph<Label, Weight>& graph,
+                                int threads = 0);
+
+    /** fill the table with the cheapest cost from every source to every
+        target, WeightTraits<Weight>::infinity() where there is no path
+        or either label is missing */
+    void compute(const std::vector<Label>& sources,
+                 const std::vector<Label>& targets);
+
+    /** return the cost from sources[source] to targets[target] */
+    Cost getCost(size_t source, size_t target) const;
+
+    /** every cost, row major: source * getNumTargets() + target */
+    const std::vector<Cost>& getCosts() const;
+
+    /** return number of sources of the last compute */
+    size_t getNumSources() const;
+
+    /** return number of targets of the last compute */
+    size_t getNumTargets() const;
+
+    /** return vertices settled by all searches of the last compute,
+        at most min(sources, targets) times the number of vertices */
+    uint64_t getSettled() const;
+
+ private:
+    const BasicIndexedGraph<Label, Weight>& graph;
+    int threads;
+
+    /** out-edges of each vertex: start, then neighbor ids and costs */
+    std::vector<int> forwardStart;
+    std::vector<int> forwardTo;
+    std::vector<Cost> forwardCost;
+
+    /** in-edges of each vertex, for the searches from the targets */
+    std::vector<int> backwardStart;
+    std::vector<int> backwardFrom;
+    std::vector<Cost> backwardCost;
+
+    size_t sourceCount {0};
+    size_t targetCount {0};
+    std::vector<Cost> costs;
+    uint64_t settled {0};
+};
+
+/** distance table of the assignment's Graph */
+typedef BasicDistanceTable<std::string, int> DistanceTable;
+
+#endif  // DISTANCETABLE_H
@@ -7,33 +7,48 @@
 ////////////////////////////////////////////////////////////////////////////////
 
 
-Edge::Edge() {}
+template <typename Label, typename Weight>
+BasicEdge<Label, Weight>::BasicEdge() {}
 
-Edge::Edge(const Edge &rhs)
+template <typename Label, typename Weight>
+BasicEdge<Label, Weight>::BasicEdge(const BasicEdge &rhs)
 {
   endVertex = rhs.getEndVertex();
   edgeWeight = rhs.getWeight();
 }
 
 /** constructor with label and weight */
-Edge::Edge(const std::string& end, int weight) { 
+template <typename Label, typename Weight>
+BasicEdge<Label, Weight>::BasicEdge(const Label& end, Weight weight) { 
   endVertex = end;
   edgeWeight = weight;
 }
 
-bool Edge::operator>(const Edge &rhs) const
+template <typename Label, typename Weight>
+bool BasicEdge<Label, Weight>::operator>(const BasicEdge &rhs) const
 {
   return getWeight() > rhs.getWeight();
 }
 
-bool Edge::operator<(const Edge &rhs) const
+template <typename Label, typename Weight>
+bool BasicEdge<Label, Weight>::operator<(const BasicEdge &rhs) const
 {
   return getWeight() < rhs.getWeight();
 }
 /** return the vertex this edge connects to */
-std::string Edge::getEndVertex() const { return endVertex; }
+template <typename Label, typename Weight>
+Label BasicEdge<Label, Weight>::getEndVertex() const { return endVertex; }
 
 /** return the weight/cost of travlleing via this edge */
-int Edge::getWeight() const { return edgeWeight; }
-
-
+template <typename Label, typename Weight>
+Weight BasicEdge<Label, Weight>::getWeight() const { return edgeWeight; }
+
+// the label and weight types BasicGraph supports
+template class BasicEdge<std::string, int>;
+template class BasicEdge<std::string, long long>;
+template class BasicEdge<std::string, double>;
+template class BasicEdge<std::string, Unweighted>;
+template class BasicEdge<int, int>;
+template class BasicEdge<int, long long>;
+template class BasicEdge<int, double>;
+template class BasicEdge<int, Unweighted>;
@@ -2,43 +2,87 @@
  * Used by vertex to keep track of all the vertices connects to
  * Each edge has a weight, possibly 0
  * Edge is a simple container class, no interesting functions
+ *
+ * BasicEdge is templated over the label and weight types,
+ * Edge is the std::string / int edge the assignment uses
  */
 
 #ifndef EDGE_H
 #define EDGE_H
 
+#include <istream>
+#include <limits>
 #include <string>
 
-class Edge {
+/** weight type for graphs where every edge costs the same
+    all Unweighted values compare equal */
+struct Unweighted {
+    bool operator<(const Unweighted&) const { return false; }
+    bool operator>(const Unweighted&) const { return false; }
+    bool operator==(const Unweighted&) const { return true; }
+};
+
+/** unweighted graphs still read "from to weight" lines, the weight
+    column is read and thrown away */
+inline std::istream& operator>>(std::istream& in, Unweighted&) {
+    int ignored = 0;
+    return in >> ignored;
+}
+
+/** how a weight turns into the cost of a path
+    Cost is what Djikstra adds up, so it has to hold the sum of a path */
+template <typename Weight>
+struct WeightTraits {
+    typedef Weight Cost;
+    static const bool weighted = true;
+    static Cost cost(const Weight& weight) { return weight; }
+    static bool isNegative(const Weight& weight) { return weight < Weight(); }
+    static Cost infinity() { return std::numeric_limits<Cost>::max(); }
+};
+
+/** every unweighted edge costs one hop */
+template <>
+struct WeightTraits<Unweighted> {
+    typedef int Cost;
+    static const bool weighted = false;
+    static Cost cost(const Unweighted&) { return 1; }
+    static bool isNegative(const Unweighted&) { return false; }
+    static Cost infinity() { return std::numeric_limits<Cost>::max(); }
+};
+
+template <typename Label, typename Weight>
+class BasicEdge {
  public:
     /** empty edge constructor */
-    Edge();
+    BasicEdge();
 
     //copy construct
-    Edge(const Edge &rhs);
+    BasicEdge(const BasicEdge &rhs);
 
     /** constructor with label and weight */
-    Edge(const std::string& end, int weight);
+    BasicEdge(const Label& end, Weight weight);
 
     //operator neccisary for pq
-    bool operator>(const Edge &rhs) const;
-    bool operator<(const Edge &rhs) const;
+    bool operator>(const BasicEdge &rhs) const;
+    bool operator<(const BasicEdge &rhs) const;
     
     /** return the vertex this edge connects to */
-    std::string getEndVertex() const;
+    Label getEndVertex() const;
 
     /** return the weight/cost of travlleing via this edge */
-    int getWeight() const;
+    Weight getWeight() const;
 
     
 
  private:
     /** end vertex, cannot be changed */
-    std::string endVertex {""};
+    Label endVertex {};
 
     /** edge weight, cannot be changed */
-    int edgeWeight {0};
-};  //  end Edge
+    Weight edgeWeight {};
+};  //  end BasicEdge
 
+/** the edge used by the assignment */
+typedef BasicEdge<std::string, int> Edge;
 
 #endif  // EDGE_H
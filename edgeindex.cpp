@@ -0,0 +1,219 @@
+#include "edgeindex.h"
+
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "prefetch.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// This is 80 characters - Keep all lines under 80 characters                 //
+////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+/** no edge has both ends at id 0xffffffff */
+const uint64_t kEmpty = ~uint64_t(0);
+
+uint64_t pairKey(int from, int to) {
+  return static_cast<uint64_t>(static_cast<uint32_t>(from)) << 32 |
+         static_cast<uint32_t>(to);
+}
+
+int popcount(uint64_t word) {
+#if defined(__GNUC__) || defined(__clang__)
+  return __builtin_popcountll(word);
+#else
+  int count = 0;
+  for (; word != 0; word &= word - 1) {
+    ++count;
+  }
+  return count;
+#endif
+}
+
+}  // namespace
+
+/** hash every edge of graph
+    graph must outlive the index and not be reordered */
+template <typename Label, typename Weight>
+BasicEdgeIndex<Label, Weight>::BasicEdgeIndex(
+    const BasicIndexedGraph<Label, Weight>& graph)
+    : graph(graph) {
+  // at most half full, so probes stay short
+  size_t size = 1;
+  shift = 64;
+  while (size < 2 * static_cast<size_t>(graph.getNumEdges()) || size < 2) {
+    size *= 2;
+    --shift;
+  }
+  slots.assign(size, Slot {kEmpty, Cost()});
+
+  std::vector<int> neighbors;
+  std::vector<Cost> costs;
+  for (int v = 0; v < graph.getNumVertices(); ++v) {
+    neighbors.clear();
+    costs.clear();
+    graph.getNeighbors(v, neighbors, &costs);
+    for (size_t i = 0; i < neighbors.size(); ++i) {
+      uint64_t key = pairKey(v, neighbors[i]);
+      size_t slot = home(key);
+      while (slots[slot].key != kEmpty) {
+        slot = (slot + 1) & (slots.size() - 1);
+      }
+      slots[slot] = Slot {key, costs[i]};
+    }
+  }
+}
+
+/** build the bit matrix for the vertex ids in subset, replacing any
+    earlier one; ids outside the graph and repeats are skipped */
+template <typename Label, typename Weight>
+void BasicEdgeIndex<Label, Weight>::setDenseSubset(
+    const std::vector<int>& subset) {
+  // a repeated id would get two rows and throw the rank words off
+  int n = graph.getNumVertices();
+  denseId.assign(n, -1);
+  std::vector<int> ids;
+  for (int id : subset) {
+    if (inGraph(id) && denseId[id] < 0) {
+      denseId[id] = static_cast<int>(ids.size());
+      ids.push_back(id);
+    }
+  }
+  int k = static_cast<int>(ids.size());
+  rowWords = (k + 63) / 64;
+  bits.assign(static_cast<size_t>(k) * rowWords, 0);
+  denseCosts.clear();
+
+  // set the bits row by row, the costs go in column order
+  std::vector<int> neighbors;
+  std::vector<Cost> costs;
+  std::vector<std::pair<int, Cost>> row;
+  for (int i = 0; i < k; ++i) {
+    neighbors.clear();
+    costs.clear();
+    graph.getNeighbors(ids[i], neighbors, &costs);
+    row.clear();
+    for (size_t e = 0; e < neighbors.size(); ++e) {
+      int column = denseId[neighbors[e]];
+      if (column >= 0) {
+        row.emplace_back(column, costs[e]);
+        bits[i * rowWords + column / 64] |= uint64_t(1) << (column % 64);
+      }
+    }
+    std::sort(row.begin(), row.end(),
+              [](const std::pair<int, Cost>& a,
+                 const std::pair<int, Cost>& b) { return a.first < b.first; });
+    for (const std::pair<int, Cost>& entry : row) {
+      denseCosts.push_back(entry.second);
+    }
+  }
+
+  rank.resize(bits.size());
+  uint32_t before = 0;
+  for (size_t w = 0; w < bits.size(); ++w) {
+    rank[w] = before;
+    before += popcount(bits[w]);
+  }
+}
+
+/** return the cost of the edge between ids from and to
+    IndexedGraph::getId turns labels into ids, its -1 for a missing
+    label costs WeightTraits<Weight>::infinity() */
+template <typename Label, typename Weight>
+typename BasicEdgeIndex<Label, Weight>::Cost
+BasicEdgeIndex<Label, Weight>::getEdgeWeight(int from, int to) const {
+  if (!inGraph(from) || !inGraph(to)) {
+    return WeightTraits<Weight>::infinity();
+  }
+  if (!denseId.empty()) {
+    int row = denseId[from];
+    int column = denseId[to];
+    if (row >= 0 && column >= 0) {
+      return denseLookup(row, column);
+    }
+  }
+  return hashLookup(pairKey(from, to));
+}
+
+/** weights[i] = getEdgeWeight(pairs[i].first, pairs[i].second)
+    the slot or bit word of later pairs is prefetched while earlier
+    ones are looked up */
+template <typename Label, typename Weight>
+void BasicEdgeIndex<Label, Weight>::getEdgeWeights(
+    const std::vector<std::pair<int, int>>& pairs,
+    std::vector<Cost>& weights) const {
+  const size_t kAhead = 8;
+  size_t count = pairs.size();
+  weights.resize(count);
+  for (size_t i = 0; i < count; ++i) {
+    if (i + kAhead < count) {
+      const std::pair<int, int>& ahead = pairs[i + kAhead];
+      bool both = inGraph(ahead.first) && inGraph(ahead.second);
+      int row = denseId.empty() || !both ? -1 : denseId[ahead.first];
+      int column = denseId.empty() || !both ? -1 : denseId[ahead.second];
+      if (row >= 0 && column >= 0) {
+        prefetch(&bits[row * rowWords + column / 64]);
+      } else {
+        prefetch(&slots[home(pairKey(ahead.first, ahead.second))]);
+      }
+    }
+    weights[i] = getEdgeWeight(pairs[i].first, pairs[i].second);
+  }
+}
+
+/** bytes held by the hash table and the bit matrix */
+template <typename Label, typename Weight>
+size_t BasicEdgeIndex<Label, Weight>::getBytes() const {
+  return slots.size() * sizeof(Slot) + denseId.size() * sizeof(int) +
+         bits.size() * (sizeof(uint64_t) + sizeof(uint32_t)) +
+         denseCosts.size() * sizeof(Cost);
+}
+
+/** the slot the probe for key starts at */
+template <typename Label, typename Weight>
+size_t BasicEdgeIndex<Label, Weight>::home(uint64_t key) const {
+  // Fibonacci hashing, the top bits of the product pick the slot
+  return static_cast<size_t>((key * 0x9E3779B97F4A7C15ull) >> shift);
+}
+
+/** return true if id is a vertex of graph */
+template <typename Label, typename Weight>
+bool BasicEdgeIndex<Label, Weight>::inGraph(int id) const {
+  return id >= 0 && id < graph.getNumVertices();
+}
+
+template <typename Label, typename Weight>
+typename BasicEdgeIndex<Label, Weight>::Cost
+BasicEdgeIndex<Label, Weight>::hashLookup(uint64_t key) const {
+  for (size_t slot = home(key); slots[slot].key != kEmpty;
+       slot = (slot + 1) & (slots.size() - 1)) {
+    if (slots[slot].key == key) {
+      return slots[slot].cost;
+    }
+  }
+  return WeightTraits<Weight>::infinity();
+}
+
+template <typename Label, typename Weight>
+typename BasicEdgeIndex<Label, Weight>::Cost
+BasicEdgeIndex<Label, Weight>::denseLookup(int row, int column) const {
+  size_t word = row * rowWords + column / 64;
+  uint64_t bit = uint64_t(1) << (column % 64);
+  if ((bits[word] & bit) == 0) {
+    return WeightTraits<Weight>::infinity();
+  }
+  return denseCosts[rank[word] + popcount(bits[word] & (bit - 1))];
+}
+
+// same label and weight types as BasicGraph
+template class BasicEdgeIndex<std::string, int>;
+template class BasicEdgeIndex<std::string, long long>;
+template class BasicEdgeIndex<std::string, double>;
+template class BasicEdgeIndex<std::string, Unweighted>;
+template class BasicEdgeIndex<int, int>;
+template class BasicEdgeIndex<int, long long>;
+template class BasicEdgeIndex<int, double>;
+template class BasicEdgeIndex<int, Unweighted>;
@@ -0,0 +1,94 @@
+/**
+ * Constant time edge weight lookups over an IndexedGraph
+ * Every edge goes into an open addressing hash table keyed by the pair of
+ * vertex ids, so a lookup is one hash and usually one probe instead of a
+ * scan of the row.
+ *
+ * setDenseSubset() adds a bit matrix for a group of vertices with many
+ * edges between them: bit (i, j) says whether the i-th vertex of the group
+ * has an edge to the j-th, and the number of set bits before it says
+ * where the cost is. Lookups inside the group skip the hash entirely.
+ *
+ * A missing edge, or a vertex id outside [0, getNumVertices()), costs
+ * WeightTraits<Weight>::infinity(), like Graph::getEdgeWeight.
+ */
+
+#ifndef EDGEINDEX_H
+#define EDGEINDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "indexedgraph.h"
+
+template <typename Label, typename Weight>
+class BasicEdgeIndex {
+ public:
+    typedef typename WeightTraits<Weight>::Cost Cost;
+
+    /** hash every edge of graph
+        graph must outlive the index and not be reordered */
+    explicit BasicEdgeIndex(const BasicIndexedGraph<Label, Weight>& graph);
+
+    /** build the bit matrix for the vertex ids in subset, replacing any
+        earlier one; ids outside the graph and repeats are skipped */
+    void setDenseSubset(const std::vector<int>& subset);
+
+    /** return the cost of the edge between ids from and to
+        IndexedGraph::getId turns labels into ids, its -1 for a missing
+        label, like any id outside the graph, costs
+        WeightTraits<Weight>::infinity() */
+    Cost getEdgeWeight(int from, int to) const;
+
+    /** weights[i] = getEdgeWeight(pairs[i].first, pairs[i].second)
+        the slot or bit word of later pairs is prefetched while earlier
+        ones are looked up */
+    void getEdgeWeights(const std::vector<std::pair<int, int>>& pairs,
+                        std::vector<Cost>& weights) const;
+
+    /** bytes held by the hash table and the bit matrix */
+    size_t getBytes() const;
+
+ private:
+    const BasicIndexedGraph<Label, Weight>& graph;
+
+    /** (from << 32 | to) and its cost, kEmpty keys mark free slots */
+    struct Slot {
+      uint64_t key;
+      Cost cost;
+    };
+    std::vector<Slot> slots;
+    int shift {64};
+
+    /** position in the dense subset of each id, -1 if not in it */
+    std::vector<int> denseId;
+
+    /** 64 bit words per matrix row */
+    size_t rowWords {0};
+
+    /** the bit matrix, row after row */
+    std::vector<uint64_t> bits;
+
+    /** set bits in all the words before each word */
+    std::vector<uint32_t> rank;
+
+    /** costs of the set bits, in bit order */
+    std::vector<Cost> denseCosts;
+
+    /** the slot the probe for key starts at */
+    size_t home(uint64_t key) const;
+
+    /** return true if id is a vertex of graph */
+    bool inGraph(int id) const;
+
+    Cost hashLookup(uint64_t key) const;
+    Cost denseLookup(int row, int column) const;
+};
+
+/** edge index of the assignment's Graph */
+typedef BasicEdgeIndex<std::string, int> EdgeIndex;
+
+#endif  // EDGEINDEX_H
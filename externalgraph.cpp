@@ -0,0 +1,521 @@
+#include "externalgraph.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <queue>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "unionfind.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// This is 80 characters - Keep all lines under 80 characters                 //
+////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+/** magic, version, vertex count and edge count */
+const uint64_t kHeaderBytes = 24;
+
+const uint64_t kRecordBytes = sizeof(BinaryEdgeRecord);
+
+/** most runs merged at once, each holds a file open */
+const size_t kMaxFanIn = 256;
+
+/** edges of frontier vertices within a disk page of each other are read
+    in one go, reading the gap costs less than another seek */
+const uint64_t kMergeGap = 4096;
+
+/** the 16 bit digit of an edge's (from, to) key sorted on in pass */
+uint32_t digit(const BinaryEdgeRecord& record, int pass) {
+  uint32_t word = pass < 2 ? record.to : record.from;
+  return pass % 2 == 0 ? word & 0xFFFF : word >> 16;
+}
+
+/** sort by from, then to: least significant digit first radix sort,
+    two passes per id, skipping digits every edge shares */
+void radixSort(std::vector<BinaryEdgeRecord>& run,
+               std::vector<BinaryEdgeRecord>& scratch) {
+  scratch.resize(run.size());
+  std::vector<size_t> start(1 << 16);
+  for (int pass = 0; pass < 4; ++pass) {
+    std::fill(start.begin(), start.end(), 0);
+    for (const BinaryEdgeRecord& record : run) {
+      start[digit(record, pass)]++;
+    }
+    if (run.empty() || start[digit(run[0], pass)] == run.size()) {
+      continue;
+    }
+    size_t sum = 0;
+    for (size_t& bucket : start) {
+      size_t count = bucket;
+      bucket = sum;
+      sum += count;
+    }
+    for (const BinaryEdgeRecord& record : run) {
+      scratch[start[digit(record, pass)]++] = record;
+    }
+    run.swap(scratch);
+  }
+}
+
+/** read and check the header of a binary edge file */
+bool readHeader(std::istream& in, const std::string& path,
+                uint64_t& vertexCount, uint64_t& edgeCount,
+                std::string& error) {
+  char magic[4];
+  uint32_t version = 0;
+  in.read(magic, sizeof(magic));
+  in.read(reinterpret_cast<char*>(&version), sizeof(version));
+  in.read(reinterpret_cast<char*>(&vertexCount), sizeof(vertexCount));
+  in.read(reinterpret_cast<char*>(&edgeCount), sizeof(edgeCount));
+  if (!in || std::memcmp(magic, kBinaryEdgeMagic, sizeof(magic)) != 0 ||
+      version != kBinaryEdgeVersion) {
+    error = path + " is not a binary edge file";
+    return false;
+  }
+  return true;
+}
+
+/** the records of one spilled run, read a buffer at a time */
+struct RunCursor {
+  std::ifstream file;
+  std::vector<BinaryEdgeRecord> buffer;
+  size_t position {0};
+  size_t filled {0};
+  uint64_t remaining;
+
+  RunCursor(const std::string& path, size_t bufferRecords, uint64_t records)
+      : file(path, std::ios::in | std::ios::binary),
+        buffer(bufferRecords),
+        remaining(records) {}
+
+  /** step to the next record, false at the end of the run */
+  bool advance() {
+    if (++position < filled) {
+      return true;
+    }
+    filled = static_cast<size_t>(
+        std::min<uint64_t>(buffer.size(), remaining));
+    position = 0;
+    if (filled == 0) {
+      return false;
+    }
+    file.read(reinterpret_cast<char*>(buffer.data()),
+              static_cast<std::streamsize>(filled * kRecordBytes));
+    remaining -= filled;
+    return static_cast<bool>(file);
+  }
+
+  const BinaryEdgeRecord& record() const { return buffer[position]; }
+};
+
+/** merge the sorted runs in paths into out, their buffers and the output
+    buffer share memoryRecords records
+    @return  number of edges merged */
+uint64_t mergeRuns(const std::vector<std::string>& paths,
+                   const std::vector<uint64_t>& sizes,
+                   uint64_t memoryRecords, std::ostream& out) {
+  size_t bufferRecords = static_cast<size_t>(
+      std::max<uint64_t>(1, memoryRecords / (paths.size() + 1)));
+  std::vector<std::unique_ptr<RunCursor>> cursors;
+  typedef std::pair<std::pair<uint32_t, uint32_t>, size_t> Head;
+  std::priority_queue<Head, std::vector<Head>, std::greater<Head>> heads;
+  for (size_t r = 0; r < paths.size(); ++r) {
+    cursors.emplace_back(new RunCursor(paths[r], bufferRecords, sizes[r]));
+    if (cursors[r]->advance()) {
+      const BinaryEdgeRecord& record = cursors[r]->record();
+      heads.push(Head(std::make_pair(record.from, record.to), r));
+    }
+  }
+
+  std::vector<BinaryEdgeRecord> pending;
+  pending.reserve(bufferRecords);
+  uint64_t merged = 0;
+  while (!heads.empty()) {
+    size_t r = heads.top().second;
+    heads.pop();
+    pending.push_back(cursors[r]->record());
+    merged++;
+    if (cursors[r]->advance()) {
+      const BinaryEdgeRecord& record = cursors[r]->record();
+      heads.push(Head(std::make_pair(record.from, record.to), r));
+    }
+    if (pending.size() == bufferRecords || heads.empty()) {
+      out.write(reinterpret_cast<const char*>(pending.data()),
+                static_cast<std::streamsize>(pending.size() * kRecordBytes));
+      pending.clear();
+    }
+  }
+  return merged;
+}
+
+}  // namespace
+
+const uint32_t ExternalGraph::kUnreached;
+
+/** edges are read blockBytes at a time, depth blocks ahead */
+ExternalGraph::ExternalGraph(size_t blockBytes, int depth)
+    : blockBytes(std::max<size_t>(1, blockBytes / kRecordBytes) *
+                 kRecordBytes),
+      depth(depth) {}
+
+/** write the edges of the binary edge file input to output sorted by
+    from, then to, holding at most memoryBytes of edges at a time;
+    sorted runs that do not fit are spilled to files next to output
+    and merged
+    @return  false, with the reason in error, if a file failed */
+bool ExternalGraph::sortEdgeFile(const std::string& input,
+                                 const std::string& output,
+                                 size_t memoryBytes, std::string& error) {
+  error.clear();
+  std::ifstream in(input, std::ios::in | std::ios::binary);
+  uint64_t vertices = 0;
+  uint64_t edges = 0;
+  if (!in.is_open()) {
+    error = "cannot open " + input;
+    return false;
+  }
+  if (!readHeader(in, input, vertices, edges, error)) {
+    return false;
+  }
+
+  // sort what fits, spilling each sorted run unless it is the only one;
+  // half the memory holds the run, the other half the radix sort's copy
+  uint64_t perRun = std::max<uint64_t>(1, memoryBytes / (2 * kRecordBytes));
+  std::vector<BinaryEdgeRecord> run;
+  std::vector<BinaryEdgeRecord> scratch;
+  std::vector<std::string> runFiles;
+  std::vector<uint64_t> runSizes;
+  uint64_t remaining = edges;
+  do {
+    size_t count = static_cast<size_t>(std::min(perRun, remaining));
+    run.resize(count);
+    in.read(reinterpret_cast<char*>(run.data()),
+            static_cast<std::streamsize>(count * kRecordBytes));
+    if (!in) {
+      error = input + " has fewer edges than its header says";
+      break;
+    }
+    radixSort(run, scratch);
+    remaining -= count;
+
+    std::string path = output;
+    if (remaining > 0 || !runFiles.empty()) {
+      path += ".run" + std::to_string(runFiles.size());
+      runFiles.push_back(path);
+      runSizes.push_back(count);
+    }
+    std::ofstream out(path, std::ios::out | std::ios::binary);
+    if (path == output) {
+      BinaryEdgeWriter(out).begin(vertices, edges);
+    }
+    out.write(reinterpret_cast<const char*>(run.data()),
+              static_cast<std::streamsize>(count * kRecordBytes));
+    if (!out) {
+      error = "cannot write " + path;
+      break;
+    }
+  } while (remaining > 0);
+  std::vector<BinaryEdgeRecord>().swap(run);
+  std::vector<BinaryEdgeRecord>().swap(scratch);
+
+  // merge kMaxFanIn runs at a time until one merge can finish the job
+  size_t runCount = runFiles.size();
+  while (error.empty() && runFiles.size() > kMaxFanIn) {
+    std::vector<std::string> mergedFiles;
+    std::vector<uint64_t> mergedSizes;
+    for (size_t first = 0; first < runFiles.size(); first += kMaxFanIn) {
+      size_t last = std::min(first + kMaxFanIn, runFiles.size());
+      std::vector<std::string> group(runFiles.begin() + first,
+                                     runFiles.begin() + last);
+      std::vector<uint64_t> sizes(runSizes.begin() + first,
+                                  runSizes.begin() + last);
+      std::string path = output + ".run" + std::to_string(runCount++);
+      std::ofstream out(path, std::ios::out | std::ios::binary);
+      uint64_t expected = 0;
+      for (uint64_t size : sizes) {
+        expected += size;
+      }
+      uint64_t merged = mergeRuns(group, sizes, 2 * perRun, out);
+      if (merged != expected || !out) {
+        error = "cannot merge the sorted runs of " + output;
+      }
+      for (const std::string& done : group) {
+        std::remove(done.c_str());
+      }
+      mergedFiles.push_back(path);
+      mergedSizes.push_back(merged);
+    }
+    runFiles.swap(mergedFiles);
+    runSizes.swap(mergedSizes);
+  }
+
+  if (error.empty() && !runFiles.empty()) {
+    std::ofstream out(output, std::ios::out | std::ios::binary);
+    BinaryEdgeWriter(out).begin(vertices, edges);
+    uint64_t merged = mergeRuns(runFiles, runSizes, 2 * perRun, out);
+    if (merged != edges) {
+      error = "cannot read back the sorted runs of " + output;
+    } else if (!out) {
+      error = "cannot write " + output;
+    }
+  }
+  for (const std::string& path : runFiles) {
+    std::remove(path.c_str());
+  }
+  return error.empty();
+}
+
+/** call sink.begin with the counts of the binary edge file path,
+    sink.edge for each of its edges in file order, then sink.end,
+    reading ahead on a BlockReader thread
+    the records are passed on as they are, BasicIndexedGraphBuilder
+    refuses self loops and ids past the vertex count itself
+    @return  false, with the reason in error, if the file could not be
+             read; sink may have seen some of the edges */
+bool ExternalGraph::streamEdgeFile(const std::string& path, EdgeSink& sink,
+                                   std::string& error) {
+  uint64_t vertices = 0;
+  uint64_t edges = 0;
+  {
+    std::ifstream in(path, std::ios::in | std::ios::binary);
+    if (!in.is_open()) {
+      error = "cannot open " + path;
+      return false;
+    }
+    if (!readHeader(in, path, vertices, edges, error)) {
+      return false;
+    }
+  }
+  BlockReader reader(path, ((size_t(4) << 20) / kRecordBytes) * kRecordBytes);
+  if (!reader.isOpen()) {
+    error = "cannot open " + path;
+    return false;
+  }
+  sink.begin(vertices, edges);
+  if (edges > 0) {
+    reader.schedule({{kHeaderBytes, edges * kRecordBytes}});
+  }
+  const char* data;
+  size_t bytes;
+  uint64_t offset;
+  while (reader.next(data, bytes, offset)) {
+    for (size_t b = 0; b + kRecordBytes <= bytes; b += kRecordBytes) {
+      BinaryEdgeRecord record;
+      std::memcpy(&record, data + b, sizeof(record));
+      sink.edge(record.from, record.to, record.weight);
+    }
+  }
+  if (reader.failed()) {
+    error = path + " has fewer edges than its header says";
+    return false;
+  }
+  sink.end();
+  return true;
+}
+
+/** open a binary edge file sorted by from, one sequential pass finds
+    where each vertex's edges start
+    @return  false, with the reason in error, if the file is not a
+             sorted binary edge file */
+bool ExternalGraph::open(const std::string& path, std::string& error) {
+  reader.reset();
+  offsets.clear();
+  vertexCount = edgeCount = 0;
+  direct.close();
+  direct.clear();
+  direct.open(path, std::ios::in | std::ios::binary);
+  if (!direct.is_open()) {
+    error = "cannot open " + path;
+    return false;
+  }
+  uint64_t vertices = 0;
+  uint64_t edges = 0;
+  if (!readHeader(direct, path, vertices, edges, error)) {
+    return false;
+  }
+  if (vertices > static_cast<uint64_t>(INT_MAX)) {
+    error = path + " has more than 2^31 - 1 vertices";
+    return false;
+  }
+  vertexCount = vertices;
+  edgeCount = edges;
+  reader.reset(new BlockReader(path, blockBytes, depth));
+  directBytes = 0;
+  directFailed = false;
+
+  // count the edges of each vertex, then sum them into offsets
+  offsets.assign(vertexCount + 1, 0);
+  uint32_t last = 0;
+  bool sorted = true;
+  bool inRange = true;
+  readExtents({{kHeaderBytes, edgeCount * kRecordBytes}},
+              [&](const char* data, size_t bytes) {
+    for (size_t b = 0; b < bytes; b += kRecordBytes) {
+      BinaryEdgeRecord record;
+      std::memcpy(&record, data + b, sizeof(record));
+      if (record.from >= vertexCount || record.to >= vertexCount) {
+        inRange = false;
+        return;
+      }
+      sorted = sorted && record.from >= last;
+      last = record.from;
+      offsets[record.from + 1]++;
+    }
+  });
+  if (failed()) {
+    error = path + " has fewer edges than its header says";
+  } else if (!inRange) {
+    error = path + " has an edge to a vertex past its vertex count";
+  } else if (!sorted) {
+    error = path + " is not sorted, see ExternalGraph::sortEdgeFile";
+  }
+  if (!error.empty()) {
+    offsets.clear();
+    vertexCount = edgeCount = 0;
+    return false;
+  }
+  for (uint64_t v = 0; v < vertexCount; ++v) {
+    offsets[v + 1] += offsets[v];
+  }
+  return true;
+}
+
+/** return number of vertices, ids are 0 .. getNumVertices() - 1 */
+uint64_t ExternalGraph::getNumVertices() const { return vertexCount; }
+
+/** return number of edges */
+uint64_t ExternalGraph::getNumEdges() const { return edgeCount; }
+
+/** return number of edges leaving vertex */
+uint64_t ExternalGraph::getDegree(uint32_t vertex) const {
+  return vertex < vertexCount ? offsets[vertex + 1] - offsets[vertex] : 0;
+}
+
+/** level[v] = fewest edges on a path from start to v,
+    kUnreached if there is none
+    @return  number of vertices reached, start included */
+uint64_t ExternalGraph::breadthFirstSearch(uint32_t start,
+                                           std::vector<uint32_t>& level) {
+  level.assign(vertexCount, kUnreached);
+  if (start >= vertexCount) {
+    return 0;
+  }
+  level[start] = 0;
+  uint64_t reached = 1;
+  std::vector<uint32_t> frontier(1, start);
+  std::vector<uint32_t> next;
+  std::vector<BlockReader::Extent> extents;
+  for (uint32_t distance = 0; !frontier.empty(); ++distance) {
+    // frontier edges in file order, close ones merged into one read
+    std::sort(frontier.begin(), frontier.end());
+    extents.clear();
+    for (uint32_t v : frontier) {
+      uint64_t begin = kHeaderBytes + offsets[v] * kRecordBytes;
+      uint64_t end = kHeaderBytes + offsets[v + 1] * kRecordBytes;
+      if (begin == end) {
+        continue;
+      }
+      if (!extents.empty() &&
+          begin <= extents.back().offset + extents.back().bytes + kMergeGap) {
+        extents.back().bytes = end - extents.back().offset;
+      } else {
+        extents.push_back(BlockReader::Extent {begin, end - begin});
+      }
+    }
+
+    // merged gaps bring in edges of vertices not on this level, skip them
+    next.clear();
+    readExtents(extents, [&](const char* data, size_t bytes) {
+      for (size_t b = 0; b < bytes; b += kRecordBytes) {
+        BinaryEdgeRecord record;
+        std::memcpy(&record, data + b, sizeof(record));
+        if (level[record.from] == distance &&
+            level[record.to] == kUnreached) {
+          level[record.to] = distance + 1;
+          next.push_back(record.to);
+        }
+      }
+    });
+    reached += next.size();
+    frontier.swap(next);
+  }
+  return reached;
+}
+
+/** component[v] = weak component of v, edges taken both ways,
+    numbered from 0 in order of each component's lowest vertex
+    @return  number of components */
+uint32_t ExternalGraph::weakComponents(std::vector<uint32_t>& component) {
+  int n = static_cast<int>(vertexCount);
+  ConcurrentUnionFind sets(n);
+  readExtents({{kHeaderBytes, edgeCount * kRecordBytes}},
+              [&](const char* data, size_t bytes) {
+    for (size_t b = 0; b < bytes; b += kRecordBytes) {
+      BinaryEdgeRecord record;
+      std::memcpy(&record, data + b, sizeof(record));
+      sets.unite(static_cast<int>(record.from), static_cast<int>(record.to));
+    }
+  });
+
+  // roots are the lowest vertex of their set, so they come first
+  component.assign(n, kUnreached);
+  uint32_t count = 0;
+  for (int v = 0; v < n; ++v) {
+    int root = sets.find(v);
+    component[v] = root == v ? count++ : component[root];
+  }
+  return count;
+}
+
+/** return bytes read from the edge file since open */
+uint64_t ExternalGraph::getBytesRead() const {
+  return directBytes + (reader ? reader->getBytesRead() : 0);
+}
+
+/** return true if a read came up short since open, the file changed
+    and the last answer is incomplete */
+bool ExternalGraph::failed() const {
+  return directFailed || (reader && reader->failed());
+}
+
+/** call process(data, bytes) on every piece of the extents in order,
+    extents must hold whole records */
+template <typename Process>
+void ExternalGraph::readExtents(
+    const std::vector<BlockReader::Extent>& extents, Process process) {
+  uint64_t total = 0;
+  for (const BlockReader::Extent& extent : extents) {
+    total += extent.bytes;
+  }
+  if (total > blockBytes) {
+    reader->schedule(extents);
+    const char* data;
+    size_t bytes;
+    uint64_t offset;
+    while (reader->next(data, bytes, offset)) {
+      process(data, bytes);
+    }
+    return;
+  }
+
+  // a hand-off to the I/O thread costs more than reading this little
+  directBuffer.resize(static_cast<size_t>(total));
+  for (const BlockReader::Extent& extent : extents) {
+    direct.clear();
+    direct.seekg(static_cast<std::streamoff>(extent.offset));
+    direct.read(directBuffer.data(),
+                static_cast<std::streamsize>(extent.bytes));
+    directBytes += direct.gcount();
+    if (static_cast<uint64_t>(direct.gcount()) != extent.bytes) {
+      directFailed = true;
+      return;
+    }
+    process(directBuffer.data(), static_cast<size_t>(extent.bytes));
+  }
+}
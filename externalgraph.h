@@ -0,0 +1,120 @@
+/**
+ * Semi-external traversals over a binary edge file
+ * For graphs whose edges do not fit in memory. Only per-vertex state is
+ * kept in RAM: the position of every vertex's first edge in the file (8
+ * bytes a vertex) plus the level or component array of the query (4
+ * bytes). The edges stay on disk in the file GraphGenerator writes with
+ * BinaryEdgeWriter, sorted by source vertex, and are read in large blocks
+ * by a BlockReader thread that keeps the next blocks coming while the
+ * current one is processed.
+ *
+ * breadthFirstSearch reads, level by level, the edges of the frontier in
+ * file order; nearby runs of edges are merged into one read, so wide
+ * levels become a sequential scan. weakComponents streams the whole file
+ * once into a union-find.
+ *
+ * sortEdgeFile puts an unsorted file in order with an external merge sort,
+ * so the generator output of any size can be used. streamEdgeFile replays
+ * a file into any EdgeSink, e.g. BasicIndexedGraphBuilder.
+ */
+
+#ifndef EXTERNALGRAPH_H
+#define EXTERNALGRAPH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "blockreader.h"
+#include "graphgenerator.h"
+
+class ExternalGraph {
+ public:
+    /** level of a vertex breadthFirstSearch did not reach */
+    static const uint32_t kUnreached = 0xFFFFFFFF;
+
+    /** edges are read blockBytes at a time, depth blocks ahead */
+    explicit ExternalGraph(size_t blockBytes = size_t(4) << 20,
+                           int depth = 4);
+
+    /** write the edges of the binary edge file input to output sorted by
+        from, then to, holding at most memoryBytes of edges at a time;
+        sorted runs that do not fit are spilled to files next to output
+        and merged
+        @return  false, with the reason in error, if a file failed */
+    static bool sortEdgeFile(const std::string& input,
+                             const std::string& output, size_t memoryBytes,
+                             std::string& error);
+
+    /** call sink.begin with the counts of the binary edge file path,
+        sink.edge for each of its edges in file order, then sink.end,
+        reading ahead on a BlockReader thread
+        the records are passed on as they are, BasicIndexedGraphBuilder
+        refuses self loops and ids past the vertex count itself
+        @return  false, with the reason in error, if the file could not be
+                 read; sink may have seen some of the edges */
+    static bool streamEdgeFile(const std::string& path, EdgeSink& sink,
+                               std::string& error);
+
+    /** open a binary edge file sorted by from, one sequential pass finds
+        where each vertex's edges start
+        @return  false, with the reason in error, if the file is not a
+                 sorted binary edge file */
+    bool open(const std::string& path, std::string& error);
+
+    /** return number of vertices, ids are 0 .. getNumVertices() - 1 */
+    uint64_t getNumVertices() const;
+
+    /** return number of edges */
+    uint64_t getNumEdges() const;
+
+    /** return number of edges leaving vertex */
+    uint64_t getDegree(uint32_t vertex) const;
+
+    /** level[v] = fewest edges on a path from start to v,
+        kUnreached if there is none
+        @return  number of vertices reached, start included */
+    uint64_t breadthFirstSearch(uint32_t start, std::vector<uint32_t>& level);
+
+    /** component[v] = weak component of v, edges taken both ways,
+        numbered from 0 in order of each component's lowest vertex
+        @return  number of components */
+    uint32_t weakComponents(std::vector<uint32_t>& component);
+
+    /** return bytes read from the edge file since open */
+    uint64_t getBytesRead() const;
+
+    /** return true if a read came up short since open, the file changed
+        and the last answer is incomplete */
+    bool failed() const;
+
+ private:
+    size_t blockBytes;
+    int depth;
+
+    uint64_t vertexCount {0};
+    uint64_t edgeCount {0};
+
+    /** offsets[v] is the index of v's first edge, vertexCount + 1 of them */
+    std::vector<uint64_t> offsets;
+
+    /** background reads, for passes over more than a block */
+    std::unique_ptr<BlockReader> reader;
+
+    /** reads on the calling thread, for passes that fit in a block */
+    std::ifstream direct;
+    std::vector<char> directBuffer;
+    uint64_t directBytes {0};
+    bool directFailed {false};
+
+    /** call process(data, bytes) on every piece of the extents in order,
+        extents must hold whole records */
+    template <typename Process>
+    void readExtents(const std::vector<BlockReader::Extent>& extents,
+                     Process process);
+};
+
+#endif  // EXTERNALGRAPH_H
@@ -3,6 +3,7 @@
 #include <set>
 #include <iostream>
 #include <fstream>
+#include <functional>
 #include <map>
 #include <unordered_map>
 #include <sstream>
@@ -24,15 +25,18 @@
 
 
 /** constructor, empty graph */
-Graph::Graph() {
+template <typename Label, typename Weight, bool Directed>
+BasicGraph<Label, Weight, Directed>::BasicGraph() {
   numberOfEdges = 0;
   numberOfVertices = 0;
+  version = 0;
 }
 
 /** destructor, delete all vertices and edges
     only vertices stored in map
     no pointers to edges created by graph */
-Graph::~Graph() {
+template <typename Label, typename Weight, bool Directed>
+BasicGraph<Label, Weight, Directed>::~BasicGraph() {
   numberOfEdges = 0;
   numberOfVertices = 0;
 
@@ -42,22 +46,37 @@ Graph::~Graph() {
 }
 
 /** return number of vertices */
-int Graph::getNumVertices() const { return numberOfVertices; }
+template <typename Label, typename Weight, bool Directed>
+int BasicGraph<Label, Weight, Directed>::getNumVertices() const {
+  return numberOfVertices;
+}
 
 /** return number of vertices */
-int Graph::getNumEdges() const { return numberOfEdges; }
+template <typename Label, typename Weight, bool Directed>
+int BasicGraph<Label, Weight, Directed>::getNumEdges() const {
+  return numberOfEdges;
+}
+
+/** return a counter that changes whenever the graph does
+    caches built from the graph compare it to tell they are stale */
+template <typename Label, typename Weight, bool Directed>
+uint64_t BasicGraph<Label, Weight, Directed>::getVersion() const {
+  return version;
+}
 
 /** add a new edge between start and end vertex
     if the vertices do not exist, create them
     calls Vertex::connect
     a vertex cannot connect to itself
-    or have multiple edges to another vertex */
-bool Graph::add(std::string start, std::string end, int edgeWeight) {
-  // I am assuming that the graph will be directed
-  // So an undirected graph would need to essentially duplicate this but reverse
-  // the "polarity"
-
-  if (edgeWeight < 0 || start == end) {
+    or have multiple edges to another vertex
+    an undirected graph connects both ways and counts one edge */
+template <typename Label, typename Weight, bool Directed>
+bool BasicGraph<Label, Weight, Directed>::add(const Label& start,
+                                              const Label& end,
+                                              Weight edgeWeight) {
+  // An undirected graph duplicates the edge but reverses the "polarity"
+
+  if (WeightTraits<Weight>::isNegative(edgeWeight) || start == end) {
     return false;
   }
 
@@ -65,19 +84,23 @@ bool Graph::add(std::string start, std::string end, int edgeWeight) {
   auto endVertex = vertices.find(end);
 
   if (startVertex == vertices.end()) {
-    startVertex = vertices.emplace(start, Vertex(start)).first;
+    startVertex = vertices.emplace(start, VertexType(start)).first;
     numberOfVertices++;
   }
 
   if (endVertex == vertices.end()) {
 
     
-    endVertex = vertices.emplace(end, Vertex(end)).first;
+    endVertex = vertices.emplace(end, VertexType(end)).first;
     numberOfVertices++;
   }
 
   if (startVertex->second.connect(end, edgeWeight)) {
+    if (!Directed) {
+      endVertex->second.connect(start, edgeWeight);
+    }
     numberOfEdges++;
+    version++;
     return true;
   }
   
@@ -88,25 +111,31 @@ bool Graph::add(std::string start, std::string end, int edgeWeight) {
 
 
 /** return weight of the edge between start and end
-    returns INT_MAX if not connected or vertices don't exist */
-int Graph::getEdgeWeight(std::string start, std::string end) const {
+    returns INT_MAX if not connected or vertices don't exist
+    (the largest Cost for other weight types, 1 for Unweighted edges) */
+template <typename Label, typename Weight, bool Directed>
+typename BasicGraph<Label, Weight, Directed>::Cost
+BasicGraph<Label, Weight, Directed>::getEdgeWeight(const Label& start,
+                                                   const Label& end) const {
   auto vertexStart = vertices.find(start);
-  auto vertexEnd = vertices.find(end);
 
-  if (vertexStart == vertices.end() || vertexEnd == vertices.end()) {
-    return false;
+  // a missing end vertex is simply not in the adjacency list,
+  // so one lookup in vertices is enough
+  if (vertexStart == vertices.end()) {
+    return WeightTraits<Weight>::infinity();
   }
 
-  int result = vertexStart->second.getEdgeWeight(end);
+  Cost result = vertexStart->second.getEdgeWeight(end);
 
-  return (result < 0) ? INT_MAX : result;
+  return (result < 0) ? WeightTraits<Weight>::infinity() : result;
 }
 
 /** read edges from file
     the first line of the file is an integer, indicating number of edges
     each edge line is in the form of "string string int"
     fromVertex  toVertex    edgeWeight */
-void Graph::readFile(std::string filename) {
+template <typename Label, typename Weight, bool Directed>
+void BasicGraph<Label, Weight, Directed>::readFile(std::string filename) {
 
   //open file, if cant then bail
   std::ifstream file(filename);
@@ -116,15 +145,16 @@ void Graph::readFile(std::string filename) {
     return;
   }
 
-  int weight = 0;
+  int edgeCount = 0;
+  Weight weight = Weight();
   //assume file is properly formatted
 
-  std::string start;
-  std::string end;
+  Label start = Label();
+  Label end = Label();
 
-  //discard the weight. its not needed unless file integrety is important
+  //discard the count. its not needed unless file integrety is important
   //add already counts the number of paths, nodes implicitly
-  file >> weight;
+  file >> edgeCount;
 
   while (!file.eof()) {
     file >> start;
@@ -135,13 +165,42 @@ void Graph::readFile(std::string filename) {
   }
 }
 
+/** call visit on every vertex, in label order */
+template <typename Label, typename Weight, bool Directed>
+void BasicGraph<Label, Weight, Directed>::forEachVertex(
+    const std::function<void(const Label&)>& visit) const {
+  for (const auto& vertexPair : vertices) {
+    visit(vertexPair.first);
+  }
+}
+
+/** call visit(from, to, cost) on every edge
+    grouped by from vertex in label order, then by to in label order
+    an undirected edge is visited once from each end */
+template <typename Label, typename Weight, bool Directed>
+void BasicGraph<Label, Weight, Directed>::forEachEdge(
+    const std::function<void(const Label&, const Label&, Cost)>& visit)
+    const {
+  for (const auto& vertexPair : vertices) {
+    vertexPair.second.forEachNeighbor(
+        [&](const BasicEdge<Label, Weight>& edge) {
+          visit(vertexPair.first, edge.getEndVertex(),
+                WeightTraits<Weight>::cost(edge.getWeight()));
+        });
+  }
+}
+
 /** depth-first traversal starting from startLabel
     call the function visit on each vertex label */
-void Graph::depthFirstTraversal(std::string startLabel,
-                                void visit(const std::string&)) 
+template <typename Label, typename Weight, bool Directed>
+void BasicGraph<Label, Weight, Directed>::depthFirstTraversal(
+    const Label& startLabel, void visit(const Label&))
 {
+  GRAPH_STATS_SCOPE("depthFirstTraversal", startLabel);
+
   //this is a map iterator
   auto search = vertices.find(startLabel);
+  GRAPH_STAT(labelLookups);
   if(search == vertices.end()) { return; }
   unvisitVertices();
 
@@ -150,17 +209,23 @@ void Graph::depthFirstTraversal(std::string startLabel,
 
 /** breadth-first traversal starting from startLabel
     call the function visit on each vertex label */
-void Graph::breadthFirstTraversal(std::string startLabel,
-                                  void visit(const std::string&)) 
+template <typename Label, typename Weight, bool Directed>
+void BasicGraph<Label, Weight, Directed>::breadthFirstTraversal(
+    const Label& startLabel, void visit(const Label&))
 {
+  GRAPH_STATS_SCOPE("breadthFirstTraversal", startLabel);
+
   //assume vertex
   auto node = vertices.find(startLabel);
+  GRAPH_STAT(labelLookups);
   if(node == vertices.end()) { return; }
 
   unvisitVertices();
-  std::queue<std::map<std::string, 
-              Vertex, std::less<std::string>>::iterator> nodeQueue;
+  std::queue<VertexIterator> nodeQueue;
+  //the start is visited too, or an edge back to it queues it again
+  node->second.visit();
   nodeQueue.push(node);
+  GRAPH_STAT(allocations);
 
   while(nodeQueue.size() > 0) {
     //Read neighbors into queue
@@ -173,18 +238,24 @@ void Graph::breadthFirstTraversal(std::string startLabel,
 
     //visit() this node
     visit(node->second.getLabel());
+    GRAPH_STAT(verticesSettled);
 
     //read adj list into queue
     for(auto it = vertices.find(node->second.getNextNeighbor()); it != node; 
       it = vertices.find(node->second.getNextNeighbor()))
     {
-      
+      GRAPH_STAT(labelLookups);
+      GRAPH_STAT(edgesRelaxed);
+
       //only lets unvisited neighbors into the queue
       if(!it->second.isVisited()){
         it->second.visit();
         nodeQueue.push(it);
+        GRAPH_STAT(allocations);
       }
     }
+    //the lookup that found the end of the list
+    GRAPH_STAT(labelLookups);
     //queue is updated, can now pop the next one.
   }
 
@@ -197,19 +268,23 @@ void Graph::breadthFirstTraversal(std::string startLabel,
     weight["F"] = 10 indicates the cost to get to "F" is 10
     record the shortest path to each vertex using given map previous
     previous["F"] = "C" indicates get to "F" via "C"
+    Unweighted graphs use a breadth-first search, costs are hop counts
 
     cpplint gives warning to use pointer instead of a non-const map
     which I am ignoring for readability */
-void Graph::djikstraCostToAllVertices(
-    std::string startLabel,
-    std::map<std::string, int>& weight,
-    std::map<std::string, std::string>& previous)
+template <typename Label, typename Weight, bool Directed>
+void BasicGraph<Label, Weight, Directed>::djikstraCostToAllVertices(
+    const Label& startLabel,
+    std::map<Label, Cost>& weight,
+    std::map<Label, Label>& previous)
 {
+  GRAPH_STATS_SCOPE("djikstraCostToAllVertices", startLabel);
 
   //I'm going to ignore the premise try to do something different
 
   //Guards
   auto node = vertices.find(startLabel);
+  GRAPH_STAT(labelLookups);
   if(node == vertices.end()) { return; }
 
 
@@ -227,19 +302,19 @@ void Graph::djikstraCostToAllVertices(
   //vertex id maps to a pair containing weight and a path
 
   //goal is to be able to access the graph data with this
-  static std::unordered_map<std::string, std::pair<int, std::deque<Vertex*>>>
-     pathWeightTable;
+  static PathWeightTable pathWeightTable;
 
   //std::pair<int, std::deque<Vertex*>> pathPair;
 
-  std::deque<Vertex*> path;
+  std::deque<VertexType*> path;
 
   //-2 for unassigned weight
   //pathPair.first = -2;
   //copy the map into this new format
   for(auto it = vertices.begin(); it != vertices.end(); it++) {
     //TODO: this needs to 
-    pathWeightTable[it->first] = std::make_pair(-2, path);
+    pathWeightTable[it->first] = std::make_pair(Cost(-2), path);
+    GRAPH_STAT(allocations);
   }
   //Table is set up
   unvisitVertices();
@@ -248,8 +323,12 @@ void Graph::djikstraCostToAllVertices(
   pathWeightTable.at(startLabel).first = 0;
   pathWeightTable.at(startLabel).second.push_back(&(node->second));
 
-  //Begin the recursion
-  dijkstraHelper(node, pathWeightTable);
+  //Begin the recursion, every hop costs the same when unweighted
+  if (WeightTraits<Weight>::weighted) {
+    dijkstraHelper(node, pathWeightTable);
+  } else {
+    hopCountHelper(node, pathWeightTable);
+  }
 
 
   //construct pq of starting node
@@ -270,8 +349,8 @@ void Graph::djikstraCostToAllVertices(
   
   bool notFirstItem = false;
 
-  std::string previousVertex;
-  int weightOut = 0;
+  Label previousVertex = Label();
+  Cost weightOut = 0;
 
   previous.clear();
   weight.clear();
@@ -289,7 +368,7 @@ void Graph::djikstraCostToAllVertices(
       notFirstItem = false;
 
       // TODO: this makes an empty arrow at the end... need to fix
-      for (Vertex* items : pathWeightTable.at(it->first).second) {
+      for (VertexType* items : pathWeightTable.at(it->first).second) {
         
         //work around for the foreach arrow problem because lazy
         if (notFirstItem) {
@@ -318,31 +397,36 @@ void Graph::djikstraCostToAllVertices(
 }
 
 //recursion, expects static
-void Graph::dijkstraHelper(
-  std::map<std::string, Vertex, std::less<std::string>>::iterator vertex,
-  std::unordered_map<std::string, std::pair<int, std::deque<Vertex*>>> &table) 
+template <typename Label, typename Weight, bool Directed>
+void BasicGraph<Label, Weight, Directed>::dijkstraHelper(
+    VertexIterator vertex, PathWeightTable &table)
 {
 
   //Base case: visited node
   if(vertex->second.isVisited()) { return; }
   vertex->second.visit();
+  GRAPH_STAT(verticesSettled);
 
 
   //TODO: this might break if vector doesnt like not having assign
   //make min  pq of paths for selected node
-  std::priority_queue<Edge, std::vector<Edge>, std::greater<Edge>> queue;
+  //edges carry the Cost so unweighted hops and big weights both fit
+  typedef BasicEdge<Label, Cost> CostEdge;
+  std::priority_queue<CostEdge, std::vector<CostEdge>,
+                      std::greater<CostEdge>> queue;
   
   //pop the map into the pq
  
   vertex->second.resetNeighbor();
-  std::string endVertex = vertex->second.getNextNeighbor();
-  std::string vertexName = vertex->second.getLabel(); //do once 
+  Label endVertex = vertex->second.getNextNeighbor();
+  Label vertexName = vertex->second.getLabel(); //do once 
 
   
   //Wow this is sloppy
   //TODO: may need to handle invalid weights
   while(endVertex != vertexName) {
-    queue.push(Edge(endVertex, vertex->second.getEdgeWeight(endVertex)));
+    queue.push(CostEdge(endVertex, vertex->second.getEdgeWeight(endVertex)));
+    GRAPH_STAT(heapPushes);
     endVertex = vertex->second.getNextNeighbor();
   }
 
@@ -356,13 +440,14 @@ void Graph::dijkstraHelper(
   
   //bookmark the smallest vertex before clearing queue
   //auto smallestVertex = vertices.find(queue.top().getEndVertex());
-  int baseWeight = table.at(vertexName).first;
-  int weightAdded = 0;
-  int targetWeight = 0;
-  int combinedWeight = 0;
+  Cost baseWeight = table.at(vertexName).first;
+  GRAPH_STAT(labelLookups);
+  Cost weightAdded = 0;
+  Cost targetWeight = 0;
+  Cost combinedWeight = 0;
 
 
-  std::map<std::string, Vertex, std::less<std::string>>::iterator iterator;
+  VertexIterator iterator;
   
 
   while(queue.size() > 0) {
@@ -373,6 +458,9 @@ void Graph::dijkstraHelper(
 
     //readcurrent total weight from table
     targetWeight = table.at(queue.top().getEndVertex()).first;
+    GRAPH_STAT(labelLookups);
+    GRAPH_STAT(labelLookups);
+    GRAPH_STAT(edgesRelaxed);
 
     combinedWeight = baseWeight + weightAdded;
 
@@ -384,9 +472,11 @@ void Graph::dijkstraHelper(
       //push mem address of the top of pq's vertex
       table.at(iterator->first).second.push_back(&(iterator->second));
       table.at(iterator->first).first = combinedWeight;
+      GRAPH_STAT(allocations);
     }
     dijkstraHelper(iterator, table);
     queue.pop();
+    GRAPH_STAT(heapPops);
   }
 
   
@@ -396,36 +486,104 @@ void Graph::dijkstraHelper(
   
 }
 
+/** Djikstra for Unweighted graphs, every edge is one hop
+    so the first time breadth-first search reaches a vertex is the
+    shortest path to it */
+template <typename Label, typename Weight, bool Directed>
+void BasicGraph<Label, Weight, Directed>::hopCountHelper(
+    VertexIterator startVertex, PathWeightTable &table)
+{
+  std::queue<VertexIterator> nodeQueue;
+  startVertex->second.visit();
+  nodeQueue.push(startVertex);
+
+  while(nodeQueue.size() > 0) {
+    VertexIterator node = nodeQueue.front();
+    nodeQueue.pop();
+    node->second.resetNeighbor();
+    GRAPH_STAT(verticesSettled);
+
+    Cost hops = table.at(node->first).first + 1;
+    GRAPH_STAT(labelLookups);
+
+    for(auto it = vertices.find(node->second.getNextNeighbor()); it != node;
+      it = vertices.find(node->second.getNextNeighbor()))
+    {
+      GRAPH_STAT(labelLookups);
+      GRAPH_STAT(edgesRelaxed);
+
+      if(!it->second.isVisited()){
+        it->second.visit();
+        //extend the parent's path by this vertex
+        table.at(it->first).second = table.at(node->first).second;
+        table.at(it->first).second.push_back(&(it->second));
+        table.at(it->first).first = hops;
+        GRAPH_STAT(allocations);
+        nodeQueue.push(it);
+      }
+    }
+  }
+}
+
 /** helper for depthFirstTraversal */
-void Graph::depthFirstTraversalHelper(
-  std::map<std::string, Vertex, std::less<std::string>>::iterator startVertex,
-                                      void visit(const std::string&)) 
+template <typename Label, typename Weight, bool Directed>
+void BasicGraph<Label, Weight, Directed>::depthFirstTraversalHelper(
+    VertexIterator startVertex, void visit(const Label&))
 {
   startVertex->second.visit();
   startVertex->second.resetNeighbor();  //This may screw it up
   visit(startVertex->second.getLabel());
+  GRAPH_STAT(verticesSettled);
 
   //janky... find once, work with this. dont spawn more strings than absolutely
   //neccisary
   auto test = vertices.find(startVertex->second.getNextNeighbor());
-  
+  GRAPH_STAT(labelLookups);
+
   while(test != startVertex) {
+    GRAPH_STAT(edgesRelaxed);
+
     //for now, assume list is valid
     if(!test->second.isVisited()) {
       depthFirstTraversalHelper(test, visit);
     }
     test = vertices.find(startVertex->second.getNextNeighbor());
+    GRAPH_STAT(labelLookups);
   }
 
   return;
 }
 
 
+#ifdef GRAPH_STATS
+/** counters for every traversal and Djikstra call so far
+    only available when built with -DGRAPH_STATS */
+template <typename Label, typename Weight, bool Directed>
+GraphStats& BasicGraph<Label, Weight, Directed>::getStats() { return stats; }
+#endif
+
 /** mark all verticies as unvisited */
-void Graph::unvisitVertices() { 
+template <typename Label, typename Weight, bool Directed>
+void BasicGraph<Label, Weight, Directed>::unvisitVertices() { 
   for (auto &vertexPair: vertices) {
     vertexPair.second.unvisit();
   }
 }
 
-
+// the label, weight and direction combinations BasicGraph supports
+template class BasicGraph<std::string, int, true>;
+template class BasicGraph<std::string, long long, true>;
+template class BasicGraph<std::string, double, true>;
+template class BasicGraph<std::string, Unweighted, true>;
+template class BasicGraph<int, int, true>;
+template class BasicGraph<int, long long, true>;
+template class BasicGraph<int, double, true>;
+template class BasicGraph<int, Unweighted, true>;
+template class BasicGraph<std::string, int, false>;
+template class BasicGraph<std::string, long long, false>;
+template class BasicGraph<std::string, double, false>;
+template class BasicGraph<std::string, Unweighted, false>;
+template class BasicGraph<int, int, false>;
+template class BasicGraph<int, long long, false>;
+template class BasicGraph<int, double, false>;
+template class BasicGraph<int, Unweighted, false>;
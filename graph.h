@@ -1,11 +1,21 @@
 /**
  * A graph is made up of vertices and edges
  * A vertex can be connected to other vertices via weighted, directed edge
+ *
+ * BasicGraph is templated over the label type, the weight type and whether
+ * edges are directed. Graph is the std::string / int directed graph the
+ * assignment uses. Integer labels skip the string compares and copies,
+ * Unweighted graphs answer Djikstra with a breadth-first search, and
+ * path costs are added up in WeightTraits<Weight>::Cost so long long
+ * weights do not overflow. Supported types are listed at the bottom of
+ * graph.cpp.
  */
 
 #ifndef GRAPH_H
 #define GRAPH_H
 
+#include <cstdint>
+#include <functional>
 #include <map>
 #include <unordered_map>
 #include <string>
@@ -13,16 +23,24 @@
  
 #include "vertex.h"
 #include "edge.h"
+#include "graphstats.h"
 
-class Graph {
+template <typename Label = std::string, typename Weight = int,
+          bool Directed = true>
+class BasicGraph {
  public:
+    typedef BasicVertex<Label, Weight> VertexType;
+    typedef typename WeightTraits<Weight>::Cost Cost;
+    typedef typename std::map<Label, VertexType, std::less<Label>>::iterator
+        VertexIterator;
+
     /** constructor, empty graph */
-    Graph();
+    BasicGraph();
 
     /** destructor, delete all vertices and edges
         only vertices stored in map
         no pointers to edges created by graph */
-    ~Graph();
+    ~BasicGraph();
 
     /** return number of vertices */
     int getNumVertices() const;
@@ -30,16 +48,23 @@ class Graph {
     /** return number of vertices */
     int getNumEdges() const;
 
+    /** return a counter that changes whenever the graph does
+        caches built from the graph compare it to tell they are stale */
+    uint64_t getVersion() const;
+
     /** add a new edge between start and end vertex
         if the vertices do not exist, create them
         calls Vertex::connect
         a vertex cannot connect to itself
-        or have multiple edges to another vertex */
-    bool add(std::string start, std::string end, int edgeWeight = 0);
+        or have multiple edges to another vertex
+        an undirected graph connects both ways and counts one edge */
+    bool add(const Label& start, const Label& end,
+             Weight edgeWeight = Weight());
 
     /** return weight of the edge between start and end
-        returns INT_MAX if not connected or vertices don't exist */
-    int getEdgeWeight(std::string start, std::string end) const;
+        returns INT_MAX if not connected or vertices don't exist
+        (the largest Cost for other weight types, 1 for Unweighted edges) */
+    Cost getEdgeWeight(const Label& start, const Label& end) const;
 
     /** read edges from file
         the first line of the file is an integer, indicating number of edges
@@ -47,15 +72,25 @@ class Graph {
         fromVertex  toVertex    edgeWeight */
     void readFile(std::string filename);
 
+    /** call visit on every vertex, in label order */
+    void forEachVertex(const std::function<void(const Label&)>& visit) const;
+
+    /** call visit(from, to, cost) on every edge
+        grouped by from vertex in label order, then by to in label order
+        an undirected edge is visited once from each end */
+    void forEachEdge(
+        const std::function<void(const Label&, const Label&, Cost)>& visit)
+        const;
+
     /** depth-first traversal starting from startLabel
         call the function visit on each vertex label */
-    void depthFirstTraversal(std::string startLabel,
-                             void visit(const std::string&));
+    void depthFirstTraversal(const Label& startLabel,
+                             void visit(const Label&));
 
     /** breadth-first traversal starting from startLabel
         call the function visit on each vertex label */
-    void breadthFirstTraversal(std::string startLabel,
-                               void visit(const std::string&));
+    void breadthFirstTraversal(const Label& startLabel,
+                               void visit(const Label&));
 
     /** find the lowest cost from startLabel to all vertices that can be reached
         using Djikstra's shortest-path algorithm
@@ -63,13 +98,20 @@ class Graph {
         weight["F"] = 10 indicates the cost to get to "F" is 10
         record the shortest path to each vertex using given map previous
         previous["F"] = "C" indicates get to "F" via "C"
+        Unweighted graphs use a breadth-first search, costs are hop counts
 
         cpplint gives warning to use pointer instead of a non-const map
         which I am ignoring for readability */
     void djikstraCostToAllVertices(
-        std::string startLabel,
-        std::map<std::string, int>& weight,
-        std::map<std::string, std::string>& previous);
+        const Label& startLabel,
+        std::map<Label, Cost>& weight,
+        std::map<Label, Label>& previous);
+
+#ifdef GRAPH_STATS
+    /** counters for every traversal and Djikstra call so far
+        only available when built with -DGRAPH_STATS */
+    GraphStats& getStats();
+#endif
 
  private:
     /** number of vertices in graph */
@@ -78,22 +120,39 @@ class Graph {
     /** number of edges in graph */
     int numberOfEdges;
 
+    /** bumped by every add that changes the graph */
+    uint64_t version;
+
     //order it just like the adjacency list
-    std::map<std::string, Vertex, std::less<std::string>> vertices;
+    std::map<Label, VertexType, std::less<Label>> vertices;
+
+    /** vertex label to (cost so far, path) for Djikstra */
+    typedef std::unordered_map<Label, std::pair<Cost, std::deque<VertexType*>>>
+        PathWeightTable;
 
     /** helper for depthFirstTraversal */
-    void depthFirstTraversalHelper(
-    std::map<std::string, Vertex, std::less<std::string>>::iterator startVertex,
-                                   void visit(const std::string&));
+    void depthFirstTraversalHelper(VertexIterator startVertex,
+                                   void visit(const Label&));
+
 
+    void dijkstraHelper(VertexIterator startVertex, PathWeightTable &table);
 
-    void dijkstraHelper(
-        std::map<std::string, Vertex, std::less<std::string>>::iterator startVertex,
-        std::unordered_map<std::string, std::pair<int, std::deque<Vertex*>>> &table);
+    /** Djikstra for Unweighted graphs, every edge is one hop
+        so the first time breadth-first search reaches a vertex is the
+        shortest path to it */
+    void hopCountHelper(VertexIterator startVertex, PathWeightTable &table);
 
     /** mark all verticies as unvisited */
     void unvisitVertices();
 
-};  // end Graph
+#ifdef GRAPH_STATS
+    /** per-query counters, see GRAPH_STAT in graphstats.h */
+    GraphStats stats;
+#endif
+
+};  // end BasicGraph
+
+/** the graph used by the assignment */
+typedef BasicGraph<std::string, int, true> Graph;
 
 #endif  // GRAPH_H
@@ -0,0 +1,378 @@
+#include "graphgenerator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////
+// This is 80 characters - Keep all lines under 80 characters                 //
+////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+/** splitmix64, the standard library distributions are not guaranteed to
+    give the same numbers on every compiler, this is */
+class Random {
+ public:
+  explicit Random(uint64_t seed) : state(seed) {}
+
+  uint64_t next() {
+    uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+  }
+
+  /** uniform in [0, bound) */
+  uint64_t below(uint64_t bound) { return next() % bound; }
+
+  /** uniform in [0, 1) */
+  double unit() {
+    return static_cast<double>(next() >> 11) / 9007199254740992.0;
+  }
+
+ private:
+  uint64_t state;
+};
+
+/** weights get their own stream so topology and weights stay independent */
+class WeightSource {
+ public:
+  explicit WeightSource(const GeneratorOptions& options)
+      : random(options.seed ^ 0xA5A5A5A5A5A5A5A5ULL),
+        distribution(options.weights),
+        low(options.minWeight),
+        high(std::max(options.minWeight, options.maxWeight)) {}
+
+  int next() {
+    switch (distribution) {
+      case WeightDistribution::Constant:
+        return low;
+      case WeightDistribution::Uniform:
+        return low + static_cast<int>(
+            random.below(static_cast<uint64_t>(high - low) + 1));
+      default: {
+        // mean of a quarter of the range above low
+        double scale = std::max(1.0, (high - low) / 4.0);
+        double drawn = -std::log(1.0 - random.unit()) * scale;
+        drawn = std::min(drawn, static_cast<double>(high - low));
+        return low + static_cast<int>(drawn);
+      }
+    }
+  }
+
+ private:
+  Random random;
+  WeightDistribution distribution;
+  int low;
+  int high;
+};
+
+uint64_t gridSide(uint64_t vertices) {
+  uint64_t side =
+      static_cast<uint64_t>(std::sqrt(static_cast<double>(vertices)));
+  while ((side + 1) * (side + 1) <= vertices) {
+    ++side;
+  }
+  while (side * side > vertices) {
+    --side;
+  }
+  return side;
+}
+
+}  // namespace
+
+TextEdgeWriter::TextEdgeWriter(std::ostream& out) : out(out) {}
+
+void TextEdgeWriter::begin(uint64_t, uint64_t edgeCount) {
+  out << edgeCount << "\n";
+}
+
+void TextEdgeWriter::edge(uint32_t from, uint32_t to, int weight) {
+  out << from << " " << to << " " << weight << "\n";
+}
+
+void TextEdgeWriter::end() { out.flush(); }
+
+BinaryEdgeWriter::BinaryEdgeWriter(std::ostream& out) : out(out) {}
+
+void BinaryEdgeWriter::begin(uint64_t vertexCount, uint64_t edgeCount) {
+  out.write(kBinaryEdgeMagic, sizeof(kBinaryEdgeMagic));
+  out.write(reinterpret_cast<const char*>(&kBinaryEdgeVersion),
+            sizeof(kBinaryEdgeVersion));
+  out.write(reinterpret_cast<const char*>(&vertexCount), sizeof(vertexCount));
+  out.write(reinterpret_cast<const char*>(&edgeCount), sizeof(edgeCount));
+}
+
+void BinaryEdgeWriter::edge(uint32_t from, uint32_t to, int weight) {
+  BinaryEdgeRecord record {from, to, static_cast<int32_t>(weight)};
+  out.write(reinterpret_cast<const char*>(&record), sizeof(record));
+}
+
+void BinaryEdgeWriter::end() { out.flush(); }
+
+GraphGenerator::GraphGenerator(const GeneratorOptions& options)
+    : options(options) {}
+
+uint64_t GraphGenerator::vertexCount() const {
+  if (options.topology == Topology::Grid) {
+    uint64_t side = gridSide(options.vertices);
+    return side * side;
+  }
+  return options.vertices;
+}
+
+uint64_t GraphGenerator::edgeCount() const {
+  std::string error;
+  if (!check(error)) {
+    return 0;
+  }
+  uint64_t n = vertexCount();
+  switch (options.topology) {
+    case Topology::Chain:
+      return n > 0 ? n - 1 : 0;
+    case Topology::Grid:
+      // right and down neighbors, both directions
+      return 4 * gridSide(n) * (gridSide(n) > 0 ? gridSide(n) - 1 : 0);
+    case Topology::Geometric:
+      return generateGeometric(nullptr);
+    default:
+      return n > 1 ? options.edges : 0;
+  }
+}
+
+bool GraphGenerator::check(std::string& error) const {
+  if (vertexCount() > 0xFFFFFFFFULL) {
+    error = "vertex ids must fit in 32 bits, " +
+            std::to_string(vertexCount()) + " vertices do not";
+    return false;
+  }
+  if (options.minWeight < 0) {
+    error = "weights must be >= 0, minWeight is " +
+            std::to_string(options.minWeight);
+    return false;
+  }
+  return true;
+}
+
+bool GraphGenerator::generate(EdgeSink& sink, std::string& error) const {
+  if (!check(error)) {
+    return false;
+  }
+  if (options.topology != Topology::Geometric) {
+    // Geometric calls begin itself once it has counted its edges
+    sink.begin(vertexCount(), edgeCount());
+  }
+  switch (options.topology) {
+    case Topology::Chain: generateChain(sink); break;
+    case Topology::Grid: generateGrid(sink); break;
+    case Topology::ErdosRenyi: generateErdosRenyi(sink); break;
+    case Topology::Rmat: generateRmat(sink); break;
+    case Topology::Geometric: generateGeometric(&sink); break;
+  }
+  sink.end();
+  return true;
+}
+
+bool GraphGenerator::parseTopology(const std::string& name,
+                                   Topology& topology) {
+  if (name == "chain") {
+    topology = Topology::Chain;
+  } else if (name == "grid") {
+    topology = Topology::Grid;
+  } else if (name == "erdos-renyi") {
+    topology = Topology::ErdosRenyi;
+  } else if (name == "rmat") {
+    topology = Topology::Rmat;
+  } else if (name == "geometric") {
+    topology = Topology::Geometric;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+bool GraphGenerator::parseWeights(const std::string& name,
+                                  WeightDistribution& weights) {
+  if (name == "constant") {
+    weights = WeightDistribution::Constant;
+  } else if (name == "uniform") {
+    weights = WeightDistribution::Uniform;
+  } else if (name == "exponential") {
+    weights = WeightDistribution::Exponential;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+void GraphGenerator::generateChain(EdgeSink& sink) const {
+  WeightSource weight(options);
+  for (uint64_t i = 0; i + 1 < options.vertices; ++i) {
+    sink.edge(static_cast<uint32_t>(i), static_cast<uint32_t>(i + 1),
+              weight.next());
+  }
+}
+
+void GraphGenerator::generateGrid(EdgeSink& sink) const {
+  WeightSource weight(options);
+  uint64_t side = gridSide(options.vertices);
+  for (uint64_t row = 0; row < side; ++row) {
+    for (uint64_t col = 0; col < side; ++col) {
+      uint32_t here = static_cast<uint32_t>(row * side + col);
+      if (col + 1 < side) {
+        sink.edge(here, here + 1, weight.next());
+        sink.edge(here + 1, here, weight.next());
+      }
+      if (row + 1 < side) {
+        uint32_t down = static_cast<uint32_t>(here + side);
+        sink.edge(here, down, weight.next());
+        sink.edge(down, here, weight.next());
+      }
+    }
+  }
+}
+
+void GraphGenerator::generateErdosRenyi(EdgeSink& sink) const {
+  uint64_t n = options.vertices;
+  if (n < 2) {
+    return;
+  }
+  Random random(options.seed);
+  WeightSource weight(options);
+  for (uint64_t i = 0; i < options.edges; ++i) {
+    uint64_t from = random.below(n);
+    uint64_t to = random.below(n - 1);
+    // skip over from so there are no self loops
+    if (to >= from) {
+      ++to;
+    }
+    sink.edge(static_cast<uint32_t>(from), static_cast<uint32_t>(to),
+              weight.next());
+  }
+}
+
+void GraphGenerator::generateRmat(EdgeSink& sink) const {
+  uint64_t n = options.vertices;
+  if (n < 2) {
+    return;
+  }
+  Random random(options.seed);
+  WeightSource weight(options);
+  int scale = 0;
+  while ((uint64_t {1} << scale) < n) {
+    ++scale;
+  }
+  uint64_t emitted = 0;
+  while (emitted < options.edges) {
+    uint64_t from = 0;
+    uint64_t to = 0;
+    for (int bit = 0; bit < scale; ++bit) {
+      // Graph500 quadrants: a = 0.57, b = 0.19, c = 0.19, d = 0.05
+      double r = random.unit();
+      if (r >= 0.57 && r < 0.76) {
+        to |= uint64_t {1} << bit;
+      } else if (r >= 0.76 && r < 0.95) {
+        from |= uint64_t {1} << bit;
+      } else if (r >= 0.95) {
+        from |= uint64_t {1} << bit;
+        to |= uint64_t {1} << bit;
+      }
+    }
+    from %= n;
+    to %= n;
+    // draw again rather than emit a self loop, keeps edgeCount exact
+    if (from == to) {
+      continue;
+    }
+    sink.edge(static_cast<uint32_t>(from), static_cast<uint32_t>(to),
+              weight.next());
+    ++emitted;
+  }
+}
+
+uint64_t GraphGenerator::generateGeometric(EdgeSink* sink) const {
+  uint64_t n = options.vertices;
+  if (n < 2 || options.edges == 0) {
+    if (sink != nullptr) {
+      sink->begin(n, 0);
+    }
+    return 0;
+  }
+  // radius giving the requested average degree: n * pi * r^2 = degree
+  double degree = static_cast<double>(options.edges) / static_cast<double>(n);
+  double radius = std::sqrt(degree / (3.14159265358979323846 *
+                                      static_cast<double>(n)));
+  radius = std::min(radius, 1.0);
+
+  Random random(options.seed);
+  std::vector<double> x(n);
+  std::vector<double> y(n);
+  for (uint64_t i = 0; i < n; ++i) {
+    x[i] = random.unit();
+    y[i] = random.unit();
+  }
+
+  // bucket points into cells at least radius wide, only neighboring cells
+  // can link; at most about one cell per point, a tiny radius would
+  // otherwise ask for billions of empty cells
+  double side = std::min(1.0 / radius, std::ceil(std::sqrt(double(n))));
+  uint64_t cells = std::max<uint64_t>(1, static_cast<uint64_t>(side));
+  auto cellOf = [cells](double coordinate) {
+    return std::min(cells - 1, static_cast<uint64_t>(coordinate * cells));
+  };
+  std::vector<uint64_t> cellStart(cells * cells + 1, 0);
+  for (uint64_t i = 0; i < n; ++i) {
+    ++cellStart[cellOf(y[i]) * cells + cellOf(x[i]) + 1];
+  }
+  for (uint64_t c = 0; c < cells * cells; ++c) {
+    cellStart[c + 1] += cellStart[c];
+  }
+  std::vector<uint32_t> cellPoints(n);
+  std::vector<uint64_t> fill(cellStart.begin(), cellStart.end() - 1);
+  for (uint64_t i = 0; i < n; ++i) {
+    cellPoints[fill[cellOf(y[i]) * cells + cellOf(x[i])]++] =
+        static_cast<uint32_t>(i);
+  }
+
+  // every point links to the others within radius, counted first so
+  // begin gets the edge count, then emitted over the same points
+  double radiusSquared = radius * radius;
+  auto link = [&](EdgeSink* out) {
+    WeightSource weight(options);
+    uint64_t count = 0;
+    for (uint64_t i = 0; i < n; ++i) {
+      uint64_t row = cellOf(y[i]);
+      uint64_t col = cellOf(x[i]);
+      for (uint64_t r = (row > 0 ? row - 1 : 0);
+           r <= std::min(cells - 1, row + 1); ++r) {
+        for (uint64_t c = (col > 0 ? col - 1 : 0);
+             c <= std::min(cells - 1, col + 1); ++c) {
+          for (uint64_t p = cellStart[r * cells + c];
+               p < cellStart[r * cells + c + 1]; ++p) {
+            uint32_t j = cellPoints[p];
+            double dx = x[i] - x[j];
+            double dy = y[i] - y[j];
+            if (j == i || dx * dx + dy * dy > radiusSquared) {
+              continue;
+            }
+            if (out != nullptr) {
+              out->edge(static_cast<uint32_t>(i), j, weight.next());
+            }
+            ++count;
+          }
+        }
+      }
+    }
+    return count;
+  };
+  uint64_t count = link(nullptr);
+  if (sink != nullptr) {
+    sink->begin(n, count);
+    link(sink);
+  }
+  return count;
+}
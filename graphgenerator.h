@@ -0,0 +1,149 @@
+/**
+ * Synthetic graph generator for large test fixtures
+ * Produces chains, grids, Erdos-Renyi, R-MAT and random geometric graphs
+ * Edges are streamed into an EdgeSink one at a time, so output size is not
+ * limited by memory. The same seed always produces the same edges.
+ */
+
+#ifndef GRAPHGENERATOR_H
+#define GRAPHGENERATOR_H
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+/** shape of the generated graph */
+enum class Topology {
+  Chain,       // 0 -> 1 -> ... -> n-1, deepest possible traversal
+  Grid,        // square lattice, edges both ways, road network stand in
+  ErdosRenyi,  // G(n, m), uniformly random edges
+  Rmat,        // recursive matrix, power law degrees
+  Geometric    // random points in the unit square, linked within a radius
+};
+
+/** how edge weights are drawn */
+enum class WeightDistribution {
+  Constant,    // always minWeight
+  Uniform,     // uniform in [minWeight, maxWeight]
+  Exponential  // many light edges, few heavy ones, clipped to maxWeight
+};
+
+struct GeneratorOptions {
+  Topology topology {Topology::Rmat};
+
+  /** number of vertices, Grid rounds down to a square */
+  uint64_t vertices {1024};
+
+  /** number of edges for ErdosRenyi and Rmat,
+      average out degree times vertices for Geometric */
+  uint64_t edges {8192};
+
+  uint64_t seed {343};
+
+  WeightDistribution weights {WeightDistribution::Uniform};
+  int minWeight {1};
+  int maxWeight {100};
+};
+
+/** receives the generated edges, begin is called once before any edge */
+class EdgeSink {
+ public:
+    virtual ~EdgeSink() {}
+
+    virtual void begin(uint64_t vertexCount, uint64_t edgeCount) = 0;
+
+    virtual void edge(uint32_t from, uint32_t to, int weight) = 0;
+
+    /** called once after the last edge */
+    virtual void end() {}
+};
+
+/** writes the "count, then from to weight" format used by readFile
+    vertex labels are the decimal vertex ids */
+class TextEdgeWriter : public EdgeSink {
+ public:
+    explicit TextEdgeWriter(std::ostream& out);
+
+    void begin(uint64_t vertexCount, uint64_t edgeCount) override;
+    void edge(uint32_t from, uint32_t to, int weight) override;
+    void end() override;
+
+ private:
+    std::ostream& out;
+};
+
+/** binary edge file, native endian
+    header: "GRPH", uint32 version, uint64 vertexCount, uint64 edgeCount
+    then edgeCount records of uint32 from, uint32 to, int32 weight */
+class BinaryEdgeWriter : public EdgeSink {
+ public:
+    explicit BinaryEdgeWriter(std::ostream& out);
+
+    void begin(uint64_t vertexCount, uint64_t edgeCount) override;
+    void edge(uint32_t from, uint32_t to, int weight) override;
+    void end() override;
+
+ private:
+    std::ostream& out;
+};
+
+/** magic and version at the start of every binary edge file */
+const char kBinaryEdgeMagic[4] = {'G', 'R', 'P', 'H'};
+const uint32_t kBinaryEdgeVersion = 1;
+
+/** one edge of a binary edge file, 12 bytes */
+struct BinaryEdgeRecord {
+  uint32_t from;
+  uint32_t to;
+  int32_t weight;
+};
+
+class GraphGenerator {
+ public:
+    explicit GraphGenerator(const GeneratorOptions& options);
+
+    /** number of vertices that will be generated */
+    uint64_t vertexCount() const;
+
+    /** exact number of edges generate will emit, 0 if check fails
+        Geometric has to place every point and search its neighbors to
+        find out, about half the work of generating it */
+    uint64_t edgeCount() const;
+
+    /** return false, with the reason in error, if the options cannot be
+        generated: ids past 32 bits, which EdgeSink and the binary format
+        cannot hold, or a negative minWeight, which Graph::add drops */
+    bool check(std::string& error) const;
+
+    /** stream every edge into sink, self loops are never emitted
+        Rmat and ErdosRenyi may emit the same edge twice,
+        Graph::add keeps the first one
+        Geometric places its points once but searches their neighbors
+        twice, first to count the edges for begin
+        @return  false, with the reason in error and nothing sent to
+                 sink, if check fails */
+    bool generate(EdgeSink& sink, std::string& error) const;
+
+    /** parse "chain", "grid", "erdos-renyi", "rmat" or "geometric"
+        @return  false if the name is unknown */
+    static bool parseTopology(const std::string& name, Topology& topology);
+
+    /** parse "constant", "uniform" or "exponential"
+        @return  false if the name is unknown */
+    static bool parseWeights(const std::string& name,
+                             WeightDistribution& weights);
+
+ private:
+    GeneratorOptions options;
+
+    void generateChain(EdgeSink& sink) const;
+    void generateGrid(EdgeSink& sink) const;
+    void generateErdosRenyi(EdgeSink& sink) const;
+    void generateRmat(EdgeSink& sink) const;
+
+    /** shared by edgeCount and generate, sink may be null to only count,
+        otherwise begin is called on it once the edges are counted */
+    uint64_t generateGeometric(EdgeSink* sink) const;
+};
+
+#endif  // GRAPHGENERATOR_H
@@ -0,0 +1,138 @@
+#include "graphstats.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <deque>
+#include <ostream>
+#include <string>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////
+// This is 80 characters - Keep all lines under 80 characters                 //
+////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+/** quote a label for JSON, labels come straight from the input file */
+std::string quoted(const std::string& text) {
+  std::string result = "\"";
+  for (char c : text) {
+    if (c == '"' || c == '\\') {
+      result += '\\';
+      result += c;
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      char escaped[8];
+      std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+      result += escaped;
+    } else {
+      result += c;
+    }
+  }
+  return result + "\"";
+}
+
+/** the counters as the body of a JSON object, shared by both exporters */
+void writeCounters(std::ostream& out, const QueryStats& entry) {
+  out << "\"verticesSettled\": " << entry.verticesSettled
+      << ", \"edgesRelaxed\": " << entry.edgesRelaxed
+      << ", \"heapPushes\": " << entry.heapPushes
+      << ", \"heapPops\": " << entry.heapPops
+      << ", \"labelLookups\": " << entry.labelLookups
+      << ", \"allocations\": " << entry.allocations;
+}
+
+}  // namespace
+
+GraphStats::GraphStats(size_t capacity)
+    : epoch(std::chrono::steady_clock::now()),
+      capacity(std::max<size_t>(1, capacity)) {}
+
+void GraphStats::begin(const std::string& query, const std::string& start) {
+  QueryStats entry;
+  entry.query = query;
+  entry.start = start;
+  entry.startMicros = microsSince(epoch);
+  queries.push_back(entry);
+  trim();
+  queryStart = std::chrono::steady_clock::now();
+}
+
+void GraphStats::end() { current().wallMicros = microsSince(queryStart); }
+
+QueryStats& GraphStats::current() {
+  // counters bumped outside a query land in a catch-all entry
+  if (queries.empty()) {
+    begin("untracked", "");
+  }
+  return queries.back();
+}
+
+const std::deque<QueryStats>& GraphStats::getQueries() const {
+  return queries;
+}
+
+void GraphStats::setCapacity(size_t capacity) {
+  this->capacity = std::max<size_t>(1, capacity);
+  trim();
+}
+
+size_t GraphStats::getCapacity() const { return capacity; }
+
+uint64_t GraphStats::getDropped() const { return dropped; }
+
+void GraphStats::clear() {
+  queries.clear();
+  dropped = 0;
+}
+
+void GraphStats::writeJson(std::ostream& out) const {
+  out << "{\"dropped\": " << dropped << ", \"queries\": [";
+  for (size_t i = 0; i < queries.size(); ++i) {
+    const QueryStats& entry = queries[i];
+    out << (i > 0 ? ",\n  " : "\n  ") << "{\"query\": "
+        << quoted(entry.query) << ", \"start\": " << quoted(entry.start)
+        << ", ";
+    writeCounters(out, entry);
+    out << ", \"startMicros\": " << entry.startMicros
+        << ", \"wallMicros\": " << entry.wallMicros << "}";
+  }
+  out << "\n]}\n";
+}
+
+void GraphStats::writeChromeTrace(std::ostream& out) const {
+  out << "{\"traceEvents\": [";
+  for (size_t i = 0; i < queries.size(); ++i) {
+    const QueryStats& entry = queries[i];
+    out << (i > 0 ? ",\n  " : "\n  ") << "{\"name\": "
+        << quoted(entry.query) << ", \"cat\": \"graph\", \"ph\": \"X\""
+        << ", \"ts\": " << entry.startMicros
+        << ", \"dur\": " << entry.wallMicros
+        << ", \"pid\": 1, \"tid\": 1, \"args\": {\"start\": "
+        << quoted(entry.start) << ", ";
+    writeCounters(out, entry);
+    out << "}}";
+  }
+  out << "\n], \"displayTimeUnit\": \"ms\"}\n";
+}
+
+GraphStats::Scope::Scope(GraphStats& stats, const std::string& query,
+                         const std::string& start)
+    : stats(stats) {
+  stats.begin(query, start);
+}
+
+GraphStats::Scope::~Scope() { stats.end(); }
+
+void GraphStats::trim() {
+  while (queries.size() > capacity) {
+    queries.pop_front();
+    ++dropped;
+  }
+}
+
+int64_t GraphStats::microsSince(
+    std::chrono::steady_clock::time_point from) const {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now() - from).count();
+}
@@ -0,0 +1,141 @@
+/**
+ * Per-query counters for Graph, compiled in only with -DGRAPH_STATS
+ * Each traversal or Djikstra call records one QueryStats entry
+ * The entries can be exported as JSON or as a Chrome trace
+ * (load the trace in chrome://tracing or https://ui.perfetto.dev)
+ * Only the most recent entries are kept, up to a capacity, so a long
+ * running process does not grow without bound; older ones are counted
+ * as dropped.
+ */
+
+#ifndef GRAPHSTATS_H
+#define GRAPHSTATS_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/** counters for a single query */
+struct QueryStats {
+  /** name of the Graph function, e.g. "breadthFirstTraversal" */
+  std::string query;
+
+  /** label the query started from */
+  std::string start;
+
+  /** vertices marked visited */
+  uint64_t verticesSettled {0};
+
+  /** edges looked at from a visited vertex */
+  uint64_t edgesRelaxed {0};
+
+  /** priority queue operations, Djikstra only */
+  uint64_t heapPushes {0};
+  uint64_t heapPops {0};
+
+  /** lookups by label in the vertex map or a label keyed table */
+  uint64_t labelLookups {0};
+
+  /** containers created or copied by the query (queue entries, paths) */
+  uint64_t allocations {0};
+
+  /** microseconds since the GraphStats was created */
+  int64_t startMicros {0};
+
+  /** wall time of the query in microseconds */
+  int64_t wallMicros {0};
+};
+
+class GraphStats {
+ public:
+    /** entries kept unless setCapacity says otherwise */
+    static const size_t kDefaultCapacity = 10000;
+
+    /** starts the clock all startMicros are measured from,
+        keeps at most capacity entries */
+    explicit GraphStats(size_t capacity = kDefaultCapacity);
+
+    /** open a new entry, counters go to it until end is called */
+    void begin(const std::string& query, const std::string& start);
+
+    /** close the current entry and record its wall time */
+    void end();
+
+    /** the entry being recorded */
+    QueryStats& current();
+
+    /** @return  the most recent queries, at most the capacity of them,
+                 oldest first */
+    const std::deque<QueryStats>& getQueries() const;
+
+    /** keep at most capacity entries, at least 1, dropping the oldest
+        right away if there are more */
+    void setCapacity(size_t capacity);
+
+    /** return most entries kept */
+    size_t getCapacity() const;
+
+    /** return number of entries dropped to stay within the capacity */
+    uint64_t getDropped() const;
+
+    /** drop every recorded query and reset the dropped count */
+    void clear();
+
+    /** {"dropped": ..., "queries": [{"query": ..., ...}]} */
+    void writeJson(std::ostream& out) const;
+
+    /** Chrome trace event format, one complete ("X") event per query
+        with the counters as args */
+    void writeChromeTrace(std::ostream& out) const;
+
+    /** begins on construction and ends on destruction,
+        so early returns are still recorded */
+    class Scope {
+     public:
+        Scope(GraphStats& stats, const std::string& query,
+              const std::string& start);
+        ~Scope();
+
+     private:
+        GraphStats& stats;
+    };
+
+ private:
+    std::chrono::steady_clock::time_point epoch;
+    std::chrono::steady_clock::time_point queryStart;
+    std::deque<QueryStats> queries;
+    size_t capacity;
+    uint64_t dropped {0};
+
+    /** drop the oldest entries until there are at most capacity */
+    void trim();
+
+    int64_t microsSince(std::chrono::steady_clock::time_point from) const;
+};
+
+/** start labels are recorded as text whatever the graph's label type is */
+inline std::string statsLabel(const std::string& label) { return label; }
+
+template <typename Label>
+std::string statsLabel(const Label& label) {
+  std::ostringstream text;
+  text << label;
+  return text.str();
+}
+
+// the hooks used inside Graph, they disappear without -DGRAPH_STATS
+#ifdef GRAPH_STATS
+#define GRAPH_STATS_SCOPE(query, start) \
+  GraphStats::Scope graphStatsScope(stats, query, statsLabel(start))
+#define GRAPH_STAT(counter) (++stats.current().counter)
+#else
+#define GRAPH_STATS_SCOPE(query, start) ((void)0)
+#define GRAPH_STAT(counter) ((void)0)
+#endif
+
+#endif  // GRAPHSTATS_H
@@ -0,0 +1,894 @@
+#include "indexedgraph.h"
+
+#ifdef __SSSE3__
+#include <tmmintrin.h>
+#endif
+
+#include <algorithm>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <queue>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "prefetch.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// This is 80 characters - Keep all lines under 80 characters                 //
+////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+/** small negative deltas become small unsigned values */
+uint32_t zigzag(int32_t value) {
+  return (static_cast<uint32_t>(value) << 1) ^
+         static_cast<uint32_t>(value >> 31);
+}
+
+int32_t unzigzag(uint32_t value) {
+  return static_cast<int32_t>(value >> 1) ^ -static_cast<int32_t>(value & 1);
+}
+
+/** 1 to 4, the bytes stream-vbyte spends on value */
+int byteLength(uint32_t value) {
+  if (value < (1u << 8)) { return 1; }
+  if (value < (1u << 16)) { return 2; }
+  if (value < (1u << 24)) { return 3; }
+  return 4;
+}
+
+/** append one row: (count + 3) / 4 control bytes, then the data bytes
+    each id is stored as the zigzag delta from the one before it,
+    the first from previous */
+void encodeRow(const int* ids, int count, int previous,
+               std::vector<uint8_t>& out) {
+  size_t control = out.size();
+  out.resize(out.size() + (count + 3) / 4, 0);
+  for (int i = 0; i < count; ++i) {
+    uint32_t value = zigzag(ids[i] - previous);
+    previous = ids[i];
+    int length = byteLength(value);
+    out[control + i / 4] |= static_cast<uint8_t>((length - 1) << (2 * (i % 4)));
+    for (int b = 0; b < length; ++b) {
+      out.push_back(static_cast<uint8_t>(value >> (8 * b)));
+    }
+  }
+}
+
+#ifdef __SSSE3__
+/** for every control byte: where each data byte lands in four 32 bit
+    lanes (0x80 zeroes a byte), and how many data bytes it covers */
+struct StreamVByteTables {
+  uint8_t shuffle[256][16];
+  uint8_t length[256];
+
+  StreamVByteTables() {
+    for (int control = 0; control < 256; ++control) {
+      int source = 0;
+      for (int lane = 0; lane < 4; ++lane) {
+        int bytes = ((control >> (2 * lane)) & 3) + 1;
+        for (int b = 0; b < 4; ++b) {
+          shuffle[control][4 * lane + b] =
+              b < bytes ? static_cast<uint8_t>(source + b) : 0x80;
+        }
+        source += bytes;
+      }
+      length[control] = static_cast<uint8_t>(source);
+    }
+  }
+};
+
+const StreamVByteTables& streamVByteTables() {
+  static const StreamVByteTables tables;
+  return tables;
+}
+#endif
+
+/** undo encodeRow into out[0 .. count - 1]
+    with SSSE3 whole groups of four are decoded with one shuffle,
+    which may read up to 16 bytes past the row */
+void decodeRow(const uint8_t* row, int count, int previous, int* out) {
+  const uint8_t* control = row;
+  const uint8_t* data = row + (count + 3) / 4;
+  int i = 0;
+#ifdef __SSSE3__
+  const StreamVByteTables& tables = streamVByteTables();
+  for (; i + 4 <= count; i += 4) {
+    uint8_t group = control[i / 4];
+    __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+    __m128i mask = _mm_loadu_si128(
+        reinterpret_cast<const __m128i*>(tables.shuffle[group]));
+    uint32_t values[4];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(values),
+                     _mm_shuffle_epi8(bytes, mask));
+    data += tables.length[group];
+    for (int lane = 0; lane < 4; ++lane) {
+      previous += unzigzag(values[lane]);
+      out[i + lane] = previous;
+    }
+  }
+#endif
+  for (; i < count; ++i) {
+    int length = ((control[i / 4] >> (2 * (i % 4))) & 3) + 1;
+    uint32_t value = 0;
+    for (int b = 0; b < length; ++b) {
+      value |= static_cast<uint32_t>(data[b]) << (8 * b);
+    }
+    data += length;
+    previous += unzigzag(value);
+    out[i] = previous;
+  }
+}
+
+/** bits needed to hold value, 0 for 0 */
+int bitsFor(uint64_t value) {
+  int bits = 0;
+  while (bits < 64 && (value >> bits) != 0) {
+    ++bits;
+  }
+  return bits;
+}
+
+/** write the low bits of value starting at bit position */
+void putBits(std::vector<uint64_t>& words, uint64_t position, int bits,
+             uint64_t value) {
+  if (bits == 0) { return; }
+  size_t word = position / 64;
+  int shift = static_cast<int>(position % 64);
+  words[word] |= value << shift;
+  if (shift + bits > 64) {
+    words[word + 1] |= value >> (64 - shift);
+  }
+}
+
+/** read bits starting at bit position */
+uint64_t getBits(const std::vector<uint64_t>& words, uint64_t position,
+                 int bits) {
+  if (bits == 0) { return 0; }
+  size_t word = position / 64;
+  int shift = static_cast<int>(position % 64);
+  uint64_t value = words[word] >> shift;
+  if (shift + bits > 64) {
+    value |= words[word + 1] << (64 - shift);
+  }
+  return bits == 64 ? value : value & ((uint64_t {1} << bits) - 1);
+}
+
+/** the label of vertex number v of an edge stream */
+void streamLabel(uint32_t v, int& label) { label = static_cast<int>(v); }
+
+void streamLabel(uint32_t v, std::string& label) {
+  label = std::to_string(v);
+}
+
+}  // namespace
+
+/** return number of vertices */
+template <typename Label, typename Weight>
+int BasicIndexedGraph<Label, Weight>::getNumVertices() const {
+  return static_cast<int>(labels.size());
+}
+
+/** return number of edges, an undirected edge counts twice */
+template <typename Label, typename Weight>
+int BasicIndexedGraph<Label, Weight>::getNumEdges() const {
+  return offsets.back();
+}
+
+/** return the id of label, -1 if there is no such vertex */
+template <typename Label, typename Weight>
+int BasicIndexedGraph<Label, Weight>::getId(const Label& label) const {
+  auto it = ids.find(label);
+  return it == ids.end() ? -1 : it->second;
+}
+
+/** return the label of id */
+template <typename Label, typename Weight>
+const Label& BasicIndexedGraph<Label, Weight>::getLabel(int id) const {
+  return labels[id];
+}
+
+/** renumber the vertices, labels and traversal order are unchanged */
+template <typename Label, typename Weight>
+void BasicIndexedGraph<Label, Weight>::reorder(VertexOrdering newOrdering) {
+  // the orderings work on the plain arrays
+  bool wasCompressed = compressed;
+  decompress();
+
+  std::vector<int> newId;
+  switch (newOrdering) {
+    case VertexOrdering::Label: {
+      // labels were handed out in label order, sort back to it
+      std::vector<int> byLabel(labels.size());
+      for (size_t i = 0; i < byLabel.size(); ++i) {
+        byLabel[i] = static_cast<int>(i);
+      }
+      std::sort(byLabel.begin(), byLabel.end(), [this](int a, int b) {
+        return labels[a] < labels[b];
+      });
+      newId.resize(labels.size());
+      for (size_t i = 0; i < byLabel.size(); ++i) {
+        newId[byLabel[i]] = static_cast<int>(i);
+      }
+      break;
+    }
+    case VertexOrdering::Degree:
+      newId = degreeOrder();
+      break;
+    case VertexOrdering::BreadthFirst:
+      newId = breadthFirstOrder();
+      break;
+    case VertexOrdering::ReverseCuthillMcKee:
+      newId = reverseCuthillMcKeeOrder();
+      break;
+  }
+  applyPermutation(newId);
+  ordering = newOrdering;
+
+  if (wasCompressed) {
+    compress();
+  }
+}
+
+/** the ordering last passed to reorder */
+template <typename Label, typename Weight>
+VertexOrdering BasicIndexedGraph<Label, Weight>::getOrdering() const {
+  return ordering;
+}
+
+/** switch to compressed adjacency, see the top of indexedgraph.h */
+template <typename Label, typename Weight>
+void BasicIndexedGraph<Label, Weight>::compress() {
+  if (compressed) { return; }
+  int n = getNumVertices();
+
+  // rows start from their own id, neighbors tend to be close to it
+  encoded.clear();
+  rowStart.assign(n + 1, 0);
+  for (int v = 0; v < n; ++v) {
+    rowStart[v] = encoded.size();
+    encodeRow(targets.data() + offsets[v], offsets[v + 1] - offsets[v], v,
+              encoded);
+  }
+  rowStart[n] = encoded.size();
+  encoded.resize(encoded.size() + 16, 0);
+  encoded.shrink_to_fit();
+
+  // Graph::add rejects negative weights, so integer costs pack unsigned
+  if (std::is_integral<Cost>::value) {
+    uint64_t largest = 0;
+    for (Cost cost : costs) {
+      largest = std::max(largest, static_cast<uint64_t>(cost));
+    }
+    costBits = bitsFor(largest);
+    uint64_t totalBits = static_cast<uint64_t>(costs.size()) * costBits;
+    packedCosts.assign(totalBits / 64 + 2, 0);
+    for (size_t e = 0; e < costs.size(); ++e) {
+      putBits(packedCosts, e * costBits, costBits,
+              static_cast<uint64_t>(costs[e]));
+    }
+    std::vector<Cost>().swap(costs);
+  }
+
+  std::vector<int>().swap(targets);
+  compressed = true;
+}
+
+/** switch back to plain offset / target / cost arrays */
+template <typename Label, typename Weight>
+void BasicIndexedGraph<Label, Weight>::decompress() {
+  if (!compressed) { return; }
+  int edges = offsets.back();
+  std::vector<int> plainTargets;
+  plainTargets.reserve(edges);
+  std::vector<Cost> plainCosts;
+  plainCosts.reserve(edges);
+  for (int v = 0; v < getNumVertices(); ++v) {
+    getNeighbors(v, plainTargets, &plainCosts);
+  }
+  targets.swap(plainTargets);
+  costs.swap(plainCosts);
+
+  std::vector<size_t>().swap(rowStart);
+  std::vector<uint8_t>().swap(encoded);
+  std::vector<uint64_t>().swap(packedCosts);
+  costBits = -1;
+  compressed = false;
+}
+
+/** return true if the adjacency is compressed */
+template <typename Label, typename Weight>
+bool BasicIndexedGraph<Label, Weight>::isCompressed() const {
+  return compressed;
+}
+
+/** bytes held by the adjacency (offsets, neighbors, costs),
+    labels and the label lookup are not counted */
+template <typename Label, typename Weight>
+size_t BasicIndexedGraph<Label, Weight>::getAdjacencyBytes() const {
+  return offsets.size() * sizeof(int) + targets.size() * sizeof(int) +
+         costs.size() * sizeof(Cost) + rowStart.size() * sizeof(size_t) +
+         encoded.size() + packedCosts.size() * sizeof(uint64_t);
+}
+
+/** return the number of edges leaving id */
+template <typename Label, typename Weight>
+int BasicIndexedGraph<Label, Weight>::getDegree(int id) const {
+  return offsets[id + 1] - offsets[id];
+}
+
+/** append the neighbors of id, in label order, to neighbors
+    and their costs to neighborCosts unless it is null
+    compressed rows are decoded on the way */
+template <typename Label, typename Weight>
+void BasicIndexedGraph<Label, Weight>::getNeighbors(
+    int id, std::vector<int>& neighbors,
+    std::vector<Cost>* neighborCosts) const {
+  int begin = offsets[id];
+  int end = offsets[id + 1];
+  if (compressed) {
+    size_t old = neighbors.size();
+    neighbors.resize(old + (end - begin));
+    decodeRow(encoded.data() + rowStart[id], end - begin, id,
+              neighbors.data() + old);
+  } else {
+    neighbors.insert(neighbors.end(), targets.begin() + begin,
+                     targets.begin() + end);
+  }
+  if (neighborCosts != nullptr) {
+    for (int e = begin; e < end; ++e) {
+      neighborCosts->push_back(getCost(e));
+    }
+  }
+}
+
+/** return the cost of the edge between ids from and to,
+    WeightTraits<Weight>::infinity() if there is none or either id
+    is outside [0, getNumVertices()), like the -1 getId returns for
+    a missing label
+    scans the row of from */
+template <typename Label, typename Weight>
+typename BasicIndexedGraph<Label, Weight>::Cost
+BasicIndexedGraph<Label, Weight>::getEdgeWeight(int from, int to) const {
+  std::vector<int> row;
+  return findEdge(from, to, row);
+}
+
+/** weights[i] = getEdgeWeight(pairs[i].first, pairs[i].second)
+    the rows of later pairs are prefetched while earlier ones are
+    scanned, so a large batch waits on memory far less than a loop
+    of single lookups */
+template <typename Label, typename Weight>
+void BasicIndexedGraph<Label, Weight>::getEdgeWeights(
+    const std::vector<std::pair<int, int>>& pairs,
+    std::vector<Cost>& weights) const {
+  // offsets are fetched kAhead pairs early and the row they point at
+  // half that, by which time its offset is already in cache
+  const size_t kAhead = 16;
+  size_t count = pairs.size();
+  int n = getNumVertices();
+  weights.resize(count);
+  std::vector<int> row;
+  for (size_t i = 0; i < count; ++i) {
+    if (i + kAhead < count && pairs[i + kAhead].first >= 0 &&
+        pairs[i + kAhead].first < n) {
+      prefetch(&offsets[pairs[i + kAhead].first]);
+    }
+    if (i + kAhead / 2 < count && pairs[i + kAhead / 2].first >= 0 &&
+        pairs[i + kAhead / 2].first < n) {
+      int ahead = offsets[pairs[i + kAhead / 2].first];
+      if (compressed) {
+        prefetch(
+            encoded.data() + rowStart[pairs[i + kAhead / 2].first]);
+      } else {
+        prefetch(targets.data() + ahead);
+      }
+      if (costBits >= 0) {
+        prefetch(packedCosts.data() +
+                           static_cast<uint64_t>(ahead) * costBits / 64);
+      } else {
+        prefetch(costs.data() + ahead);
+      }
+    }
+    weights[i] = findEdge(pairs[i].first, pairs[i].second, row);
+  }
+}
+
+/** getEdgeWeight, decoding a compressed row into row */
+template <typename Label, typename Weight>
+typename BasicIndexedGraph<Label, Weight>::Cost
+BasicIndexedGraph<Label, Weight>::findEdge(int from, int to,
+                                           std::vector<int>& row) const {
+  int n = getNumVertices();
+  if (from < 0 || to < 0 || from >= n || to >= n) {
+    return WeightTraits<Weight>::infinity();
+  }
+  int begin = offsets[from];
+  int end = offsets[from + 1];
+  const int* rowTargets = targets.data() + begin;
+  if (compressed) {
+    row.resize(end - begin);
+    decodeRow(encoded.data() + rowStart[from], end - begin, from,
+              row.data());
+    rowTargets = row.data();
+  }
+  for (int e = begin; e < end; ++e) {
+    if (rowTargets[e - begin] == to) {
+      return getCost(e);
+    }
+  }
+  return WeightTraits<Weight>::infinity();
+}
+
+/** cost of edge e, wherever it is stored */
+template <typename Label, typename Weight>
+typename BasicIndexedGraph<Label, Weight>::Cost
+BasicIndexedGraph<Label, Weight>::getCost(int e) const {
+  if (costBits >= 0) {
+    return static_cast<Cost>(getBits(
+        packedCosts, static_cast<uint64_t>(e) * costBits, costBits));
+  }
+  return costs[e];
+}
+
+/** depth-first traversal starting from startLabel
+    call the function visit on each vertex label
+    visits in the same order as Graph::depthFirstTraversal */
+template <typename Label, typename Weight>
+void BasicIndexedGraph<Label, Weight>::depthFirstTraversal(
+    const Label& startLabel, void visit(const Label&)) const {
+  int start = getId(startLabel);
+  if (start < 0) { return; }
+
+  // an explicit stack replaces the recursion, so a long chain cannot
+  // overflow the call stack. rows holds the (decoded) neighbors of every
+  // vertex on the stack, each frame is (start of its row, next neighbor)
+  // and the top frame's row runs to the end of rows
+  std::vector<char> visited(labels.size(), 0);
+  std::vector<int> rows;
+  std::vector<std::pair<size_t, size_t>> stack;
+  visited[start] = 1;
+  visit(labels[start]);
+  getNeighbors(start, rows);
+  stack.emplace_back(0, 0);
+
+  while (!stack.empty()) {
+    std::pair<size_t, size_t>& top = stack.back();
+    if (top.second == rows.size()) {
+      rows.resize(top.first);
+      stack.pop_back();
+      continue;
+    }
+    int next = rows[top.second++];
+    if (!visited[next]) {
+      visited[next] = 1;
+      visit(labels[next]);
+      size_t row = rows.size();
+      getNeighbors(next, rows);
+      stack.emplace_back(row, row);
+    }
+  }
+}
+
+/** breadth-first traversal starting from startLabel
+    call the function visit on each vertex label
+    visits in the same order as Graph::breadthFirstTraversal */
+template <typename Label, typename Weight>
+void BasicIndexedGraph<Label, Weight>::breadthFirstTraversal(
+    const Label& startLabel, void visit(const Label&)) const {
+  int start = getId(startLabel);
+  if (start < 0) { return; }
+
+  // the visit order doubles as the queue
+  std::vector<char> visited(labels.size(), 0);
+  std::vector<int> queue;
+  queue.reserve(labels.size());
+  visited[start] = 1;
+  queue.push_back(start);
+
+  std::vector<int> row;
+  for (size_t head = 0; head < queue.size(); ++head) {
+    int node = queue[head];
+    visit(labels[node]);
+    row.clear();
+    getNeighbors(node, row);
+    for (int next : row) {
+      if (!visited[next]) {
+        visited[next] = 1;
+        queue.push_back(next);
+      }
+    }
+  }
+}
+
+template <typename Label, typename Weight>
+void BasicIndexedGraph<Label, Weight>::addVertex(const Label& label) {
+  ids.emplace(label, static_cast<int>(labels.size()));
+  labels.push_back(label);
+}
+
+template <typename Label, typename Weight>
+void BasicIndexedGraph<Label, Weight>::addEdge(const Label& from,
+                                               const Label& to, Cost cost) {
+  pending.push_back(PendingEdge {ids.at(from), ids.at(to), cost});
+}
+
+/** build offsets / targets / costs out of pending */
+template <typename Label, typename Weight>
+void BasicIndexedGraph<Label, Weight>::finishEdges() {
+  // counting sort by from vertex, stable so each block keeps label order
+  offsets.assign(labels.size() + 1, 0);
+  for (const PendingEdge& edge : pending) {
+    ++offsets[edge.from + 1];
+  }
+  for (size_t v = 0; v < labels.size(); ++v) {
+    offsets[v + 1] += offsets[v];
+  }
+  targets.resize(pending.size());
+  costs.resize(pending.size());
+  std::vector<int> fill(offsets.begin(), offsets.end() - 1);
+  for (const PendingEdge& edge : pending) {
+    targets[fill[edge.from]] = edge.to;
+    costs[fill[edge.from]++] = edge.cost;
+  }
+  std::vector<PendingEdge>().swap(pending);
+}
+
+/** highest (in + out) degree first, ties keep their current order */
+template <typename Label, typename Weight>
+std::vector<int> BasicIndexedGraph<Label, Weight>::degreeOrder() const {
+  int n = getNumVertices();
+  std::vector<int> degree(n, 0);
+  for (int v = 0; v < n; ++v) {
+    degree[v] += offsets[v + 1] - offsets[v];
+    for (int e = offsets[v]; e < offsets[v + 1]; ++e) {
+      ++degree[targets[e]];
+    }
+  }
+  std::vector<int> byDegree(n);
+  for (int v = 0; v < n; ++v) {
+    byDegree[v] = v;
+  }
+  std::stable_sort(byDegree.begin(), byDegree.end(),
+                   [&degree](int a, int b) { return degree[a] > degree[b]; });
+  std::vector<int> newId(n);
+  for (int i = 0; i < n; ++i) {
+    newId[byDegree[i]] = i;
+  }
+  return newId;
+}
+
+/** breadth-first over undirected edges, each piece from its lowest id */
+template <typename Label, typename Weight>
+std::vector<int> BasicIndexedGraph<Label, Weight>::breadthFirstOrder() const {
+  int n = getNumVertices();
+  std::vector<int> start;
+  std::vector<int> neighbors;
+  undirectedAdjacency(start, neighbors);
+
+  std::vector<int> newId(n, -1);
+  std::vector<int> queue;
+  queue.reserve(n);
+  for (int root = 0; root < n; ++root) {
+    if (newId[root] >= 0) {
+      continue;
+    }
+    size_t head = queue.size();
+    newId[root] = static_cast<int>(queue.size());
+    queue.push_back(root);
+    for (; head < queue.size(); ++head) {
+      int node = queue[head];
+      for (int e = start[node]; e < start[node + 1]; ++e) {
+        if (newId[neighbors[e]] < 0) {
+          newId[neighbors[e]] = static_cast<int>(queue.size());
+          queue.push_back(neighbors[e]);
+        }
+      }
+    }
+  }
+  return newId;
+}
+
+/** Cuthill-McKee: breadth-first from a lowest degree vertex, neighbors by
+    increasing degree, then reversed */
+template <typename Label, typename Weight>
+std::vector<int>
+BasicIndexedGraph<Label, Weight>::reverseCuthillMcKeeOrder() const {
+  int n = getNumVertices();
+  std::vector<int> start;
+  std::vector<int> neighbors;
+  undirectedAdjacency(start, neighbors);
+
+  auto degree = [&start](int v) { return start[v + 1] - start[v]; };
+
+  // roots are tried lowest degree first, that is where each piece starts
+  std::vector<int> roots(n);
+  for (int v = 0; v < n; ++v) {
+    roots[v] = v;
+  }
+  std::stable_sort(roots.begin(), roots.end(), [&degree](int a, int b) {
+    return degree(a) < degree(b);
+  });
+
+  std::vector<char> placed(n, 0);
+  std::vector<int> order;
+  order.reserve(n);
+  std::vector<int> children;
+  for (int root : roots) {
+    if (placed[root]) {
+      continue;
+    }
+    size_t head = order.size();
+    placed[root] = 1;
+    order.push_back(root);
+    for (; head < order.size(); ++head) {
+      int node = order[head];
+      children.clear();
+      for (int e = start[node]; e < start[node + 1]; ++e) {
+        if (!placed[neighbors[e]]) {
+          placed[neighbors[e]] = 1;
+          children.push_back(neighbors[e]);
+        }
+      }
+      std::stable_sort(children.begin(), children.end(),
+                       [&degree](int a, int b) {
+                         return degree(a) < degree(b);
+                       });
+      order.insert(order.end(), children.begin(), children.end());
+    }
+  }
+
+  std::vector<int> newId(n);
+  for (int i = 0; i < n; ++i) {
+    newId[order[i]] = n - 1 - i;
+  }
+  return newId;
+}
+
+/** neighbors in both directions, in the same offsets / targets form
+    the orderings treat edges as undirected so a vertex lands near
+    the vertices pointing at it */
+template <typename Label, typename Weight>
+void BasicIndexedGraph<Label, Weight>::undirectedAdjacency(
+    std::vector<int>& start, std::vector<int>& neighbors) const {
+  int n = getNumVertices();
+  start.assign(n + 1, 0);
+  for (int v = 0; v < n; ++v) {
+    for (int e = offsets[v]; e < offsets[v + 1]; ++e) {
+      ++start[v + 1];
+      ++start[targets[e] + 1];
+    }
+  }
+  for (int v = 0; v < n; ++v) {
+    start[v + 1] += start[v];
+  }
+  neighbors.resize(start[n]);
+  std::vector<int> fill(start.begin(), start.end() - 1);
+  for (int v = 0; v < n; ++v) {
+    for (int e = offsets[v]; e < offsets[v + 1]; ++e) {
+      neighbors[fill[v]++] = targets[e];
+      neighbors[fill[targets[e]]++] = v;
+    }
+  }
+}
+
+/** move every array to the new ids */
+template <typename Label, typename Weight>
+void BasicIndexedGraph<Label, Weight>::applyPermutation(
+    const std::vector<int>& newId) {
+  int n = getNumVertices();
+  std::vector<int> oldId(n);
+  for (int v = 0; v < n; ++v) {
+    oldId[newId[v]] = v;
+  }
+
+  std::vector<Label> newLabels(n);
+  std::vector<int> newOffsets(n + 1, 0);
+  std::vector<int> newTargets(targets.size());
+  std::vector<Cost> newCosts(costs.size());
+  for (int v = 0; v < n; ++v) {
+    int old = oldId[v];
+    newLabels[v] = labels[old];
+    ids[labels[old]] = v;
+    int begin = offsets[old];
+    int end = offsets[old + 1];
+    newOffsets[v + 1] = newOffsets[v] + (end - begin);
+    // block order is kept, it is label order not id order
+    for (int e = begin; e < end; ++e) {
+      newTargets[newOffsets[v] + (e - begin)] = newId[targets[e]];
+      newCosts[newOffsets[v] + (e - begin)] = costs[e];
+    }
+  }
+  labels.swap(newLabels);
+  offsets.swap(newOffsets);
+  targets.swap(newTargets);
+  costs.swap(newCosts);
+}
+
+template <typename Label, typename Weight>
+BasicIndexedGraphBuilder<Label, Weight>::BasicIndexedGraphBuilder()
+    : graph(new BasicIndexedGraph<Label, Weight>()) {}
+
+template <typename Label, typename Weight>
+void BasicIndexedGraphBuilder<Label, Weight>::begin(uint64_t vertexCount,
+                                                    uint64_t edgeCount) {
+  begun = true;
+  if (vertexCount > static_cast<uint64_t>(INT_MAX) ||
+      edgeCount > static_cast<uint64_t>(INT_MAX)) {
+    failure = "more than 2^31 - 1 vertices or edges";
+    return;
+  }
+  BasicIndexedGraph<Label, Weight>& g = *graph;
+  int n = static_cast<int>(vertexCount);
+  g.labels.reserve(n);
+  g.ids.reserve(n);
+  Label label;
+  for (int v = 0; v < n; ++v) {
+    streamLabel(static_cast<uint32_t>(v), label);
+    g.addVertex(label);
+  }
+  g.offsets.reserve(n + 1);
+  g.offsets.push_back(0);
+  g.rowStart.reserve(n + 1);
+  // one control and one data byte an edge at the least
+  g.encoded.reserve(edgeCount + edgeCount / 4 + 16);
+  g.costBits = std::is_integral<Cost>::value ? 0 : -1;
+  g.compressed = true;
+}
+
+template <typename Label, typename Weight>
+void BasicIndexedGraphBuilder<Label, Weight>::edge(uint32_t from,
+                                                   uint32_t to, int weight) {
+  if (!failure.empty()) {
+    return;
+  }
+  uint64_t n = graph->labels.size();
+  if (!begun || ended) {
+    failure = "edge outside begin and end";
+  } else if (from >= n || to >= n) {
+    failure = "edge to a vertex past the vertex count";
+  } else if (from == to) {
+    failure = "self loop at " + std::to_string(from);
+  } else if (weight < 0) {
+    failure = "negative weight";
+  } else if (from < rowFrom) {
+    failure = "edges not sorted by from, see ExternalGraph::sortEdgeFile";
+  }
+  if (!failure.empty()) {
+    return;
+  }
+  if (from > rowFrom) {
+    finishRows(from);
+  }
+  // Unweighted edges cost one hop whatever the stream says
+  row.emplace_back(static_cast<int>(to),
+                   WeightTraits<Weight>::weighted ? static_cast<Cost>(weight)
+                                                  : Cost(1));
+}
+
+template <typename Label, typename Weight>
+void BasicIndexedGraphBuilder<Label, Weight>::end() {
+  if (!failure.empty() || !begun || ended) {
+    return;
+  }
+  BasicIndexedGraph<Label, Weight>& g = *graph;
+  finishRows(g.labels.size());
+  if (!failure.empty()) {
+    return;
+  }
+  g.rowStart.push_back(g.encoded.size());
+  g.encoded.resize(g.encoded.size() + 16, 0);
+  g.encoded.shrink_to_fit();
+  if (g.costBits >= 0) {
+    uint64_t totalBits = static_cast<uint64_t>(g.offsets.back()) * g.costBits;
+    g.packedCosts.resize(totalBits / 64 + 2, 0);
+    g.packedCosts.shrink_to_fit();
+  }
+  g.costs.shrink_to_fit();
+  ended = true;
+}
+
+/** the graph, once end has been called
+    @return  nullptr, with the reason in error, if the stream was not
+             sorted, had a self loop, a negative weight, an edge past
+             the vertex count or more than 2^31 - 1 vertices or
+             edges */
+template <typename Label, typename Weight>
+std::unique_ptr<BasicIndexedGraph<Label, Weight>>
+BasicIndexedGraphBuilder<Label, Weight>::finish(std::string& error) {
+  if (failure.empty() && !ended) {
+    failure = "the stream did not end";
+  }
+  if (!failure.empty()) {
+    error = failure;
+    return nullptr;
+  }
+  return std::move(graph);
+}
+
+/** encode the collected row, then empty rows until upTo is next */
+template <typename Label, typename Weight>
+void BasicIndexedGraphBuilder<Label, Weight>::finishRows(uint64_t upTo) {
+  BasicIndexedGraph<Label, Weight>& g = *graph;
+  // sorted by target, the first of repeated edges kept
+  std::stable_sort(row.begin(), row.end(),
+                   [](const std::pair<int, Cost>& a,
+                      const std::pair<int, Cost>& b) {
+                     return a.first < b.first;
+                   });
+  row.erase(std::unique(row.begin(), row.end(),
+                        [](const std::pair<int, Cost>& a,
+                           const std::pair<int, Cost>& b) {
+                          return a.first == b.first;
+                        }),
+            row.end());
+  uint64_t edges = static_cast<uint64_t>(g.offsets.back());
+  if (edges + row.size() > static_cast<uint64_t>(INT_MAX)) {
+    failure = "more than 2^31 - 1 vertices or edges";
+    return;
+  }
+  targets.clear();
+  for (const std::pair<int, Cost>& edge : row) {
+    targets.push_back(edge.first);
+    addCost(edges++, edge.second);
+  }
+  for (; rowFrom < upTo; ++rowFrom) {
+    g.rowStart.push_back(g.encoded.size());
+    encodeRow(targets.data(), static_cast<int>(targets.size()),
+              static_cast<int>(rowFrom), g.encoded);
+    g.offsets.push_back(static_cast<int>(edges));
+    targets.clear();
+  }
+  row.clear();
+}
+
+/** append the cost of edge e, widening the packing if it needs to */
+template <typename Label, typename Weight>
+void BasicIndexedGraphBuilder<Label, Weight>::addCost(uint64_t e,
+                                                      Cost cost) {
+  BasicIndexedGraph<Label, Weight>& g = *graph;
+  if (g.costBits < 0) {
+    g.costs.push_back(cost);
+    return;
+  }
+  // the widest cost so far sets the width, earlier costs are repacked
+  // when a wider one turns up, at most once per extra bit
+  int bits = bitsFor(static_cast<uint64_t>(cost));
+  if (bits > g.costBits) {
+    std::vector<uint64_t> wider(e * bits / 64 + 2, 0);
+    for (uint64_t i = 0; i < e; ++i) {
+      putBits(wider, i * bits, bits, getBits(g.packedCosts, i * g.costBits,
+                                             g.costBits));
+    }
+    g.packedCosts.swap(wider);
+    g.costBits = bits;
+  }
+  uint64_t words = (e + 1) * g.costBits / 64 + 2;
+  if (g.packedCosts.size() < words) {
+    g.packedCosts.resize(std::max(words, 2 * g.packedCosts.size()), 0);
+  }
+  putBits(g.packedCosts, e * g.costBits, g.costBits,
+          static_cast<uint64_t>(cost));
+}
+
+// same label and weight types as BasicGraph
+template class BasicIndexedGraph<std::string, int>;
+template class BasicIndexedGraph<std::string, long long>;
+template class BasicIndexedGraph<std::string, double>;
+template class BasicIndexedGraph<std::string, Unweighted>;
+template class BasicIndexedGraph<int, int>;
+template class BasicIndexedGraph<int, long long>;
+template class BasicIndexedGraph<int, double>;
+template class BasicIndexedGraph<int, Unweighted>;
+template class BasicIndexedGraphBuilder<std::string, int>;
+template class BasicIndexedGraphBuilder<std::string, long long>;
+template class BasicIndexedGraphBuilder<std::string, double>;
+template class BasicIndexedGraphBuilder<std::string, Unweighted>;
+template class BasicIndexedGraphBuilder<int, int>;
+template class BasicIndexedGraphBuilder<int, long long>;
+template class BasicIndexedGraphBuilder<int, double>;
+template class BasicIndexedGraphBuilder<int, Unweighted>;
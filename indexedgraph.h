@@ -0,0 +1,277 @@
+/**
+ * Read-only snapshot of a BasicGraph with integer vertex ids
+ * Adjacency is stored in compressed sparse row form: the edges of vertex v
+ * are targets[offsets[v]] .. targets[offsets[v + 1] - 1], so a traversal
+ * walks flat arrays instead of chasing map nodes.
+ *
+ * Ids start out in label order. reorder() renumbers them so vertices that
+ * are visited together sit together in memory. Labels, and the order the
+ * traversals visit them in, never change: each vertex keeps its neighbors
+ * in label order, exactly like Vertex::getNextNeighbor.
+ *
+ * compress() trades a little decoding for far less memory traffic: each
+ * vertex's neighbor ids become zigzag deltas in stream-vbyte form (a control
+ * byte holds the byte lengths of four values, so four values decode with
+ * one SSSE3 shuffle) and integer costs are bit packed at the smallest width
+ * that holds the largest cost. Rows are decoded as the traversals reach
+ * them. With label ids the neighbor ids of a row are sorted, so every delta
+ * is small and positive. After reorder() rows stay in label order, which
+ * is no longer id order, so deltas turn negative and grow: about 0.3 bytes
+ * an edge more on the benchmark graphs. Sorting the rows by id would take
+ * a permutation per row to give the traversals their label order back,
+ * costing about what it saves, so rows are left in label order.
+ *
+ * Limits: with 8 edges a vertex and weights up to 100 the benchmark grid,
+ * Erdos-Renyi and R-MAT graphs take 4 to 6 bytes an edge compressed against
+ * 8.5 plain, 1.5 to 2 times less rather than 4 to 8. Once ids take a byte
+ * or two, the 7 bit costs are much of what is left, and every vertex still
+ * costs 12 bytes of offset and row start, so a chain gains nothing.
+ *
+ * A graph too big for BasicGraph is built compressed from an edge stream
+ * by BasicIndexedGraphBuilder, see below, which never holds the edges
+ * uncompressed.
+ */
+
+#ifndef INDEXEDGRAPH_H
+#define INDEXEDGRAPH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "graph.h"
+#include "graphgenerator.h"
+
+/** the vertex orders reorder() can produce */
+enum class VertexOrdering {
+  Label,                   // label order, what a fresh snapshot uses
+  Degree,                  // highest degree first, hubs share cache lines
+  BreadthFirst,            // breadth-first from the lowest id of each piece
+  ReverseCuthillMcKee      // bandwidth reducing, good for grids and roads
+};
+
+template <typename Label, typename Weight>
+class BasicIndexedGraphBuilder;
+
+template <typename Label, typename Weight>
+class BasicIndexedGraph {
+ public:
+    typedef typename WeightTraits<Weight>::Cost Cost;
+
+    /** snapshot every vertex and edge of graph
+        later changes to graph are not seen */
+    template <bool Directed>
+    explicit BasicIndexedGraph(
+        const BasicGraph<Label, Weight, Directed>& graph) {
+      graph.forEachVertex([this](const Label& label) { addVertex(label); });
+      graph.forEachEdge(
+          [this](const Label& from, const Label& to, Cost cost) {
+            addEdge(from, to, cost);
+          });
+      finishEdges();
+    }
+
+    /** return number of vertices */
+    int getNumVertices() const;
+
+    /** return number of edges, an undirected edge counts twice */
+    int getNumEdges() const;
+
+    /** return the id of label, -1 if there is no such vertex */
+    int getId(const Label& label) const;
+
+    /** return the label of id */
+    const Label& getLabel(int id) const;
+
+    /** renumber the vertices, labels and traversal order are unchanged */
+    void reorder(VertexOrdering ordering);
+
+    /** the ordering last passed to reorder */
+    VertexOrdering getOrdering() const;
+
+    /** switch to compressed adjacency, see the top of this file */
+    void compress();
+
+    /** switch back to plain offset / target / cost arrays */
+    void decompress();
+
+    /** return true if the adjacency is compressed */
+    bool isCompressed() const;
+
+    /** bytes held by the adjacency (offsets, neighbors, costs),
+        labels and the label lookup are not counted */
+    size_t getAdjacencyBytes() const;
+
+    /** return the number of edges leaving id */
+    int getDegree(int id) const;
+
+    /** append the neighbors of id, in label order, to neighbors
+        and their costs to neighborCosts unless it is null
+        compressed rows are decoded on the way */
+    void getNeighbors(int id, std::vector<int>& neighbors,
+                      std::vector<Cost>* neighborCosts = nullptr) const;
+
+    /** return the cost of the edge between ids from and to,
+        WeightTraits<Weight>::infinity() if there is none or either id
+        is outside [0, getNumVertices()), like the -1 getId returns for
+        a missing label
+        scans the row of from */
+    Cost getEdgeWeight(int from, int to) const;
+
+    /** weights[i] = getEdgeWeight(pairs[i].first, pairs[i].second)
+        the rows of later pairs are prefetched while earlier ones are
+        scanned, so a large batch waits on memory far less than a loop
+        of single lookups */
+    void getEdgeWeights(const std::vector<std::pair<int, int>>& pairs,
+                        std::vector<Cost>& weights) const;
+
+    /** depth-first traversal starting from startLabel
+        call the function visit on each vertex label
+        visits in the same order as Graph::depthFirstTraversal */
+    void depthFirstTraversal(const Label& startLabel,
+                             void visit(const Label&)) const;
+
+    /** breadth-first traversal starting from startLabel
+        call the function visit on each vertex label
+        visits in the same order as Graph::breadthFirstTraversal */
+    void breadthFirstTraversal(const Label& startLabel,
+                               void visit(const Label&)) const;
+
+ private:
+    friend class BasicIndexedGraphBuilder<Label, Weight>;
+
+    /** empty, for BasicIndexedGraphBuilder to fill */
+    BasicIndexedGraph() {}
+
+    /** id to label */
+    std::vector<Label> labels;
+
+    /** label to id */
+    std::unordered_map<Label, int> ids;
+
+    /** edges of v are [offsets[v], offsets[v + 1]) */
+    std::vector<int> offsets;
+
+    /** edge target ids, each vertex's block in label order */
+    std::vector<int> targets;
+
+    /** edge costs, parallel to targets */
+    std::vector<Cost> costs;
+
+    VertexOrdering ordering {VertexOrdering::Label};
+
+    /** true once compress() has replaced targets and costs */
+    bool compressed {false};
+
+    /** byte offset of each vertex's row in encoded, plus one past the end */
+    std::vector<size_t> rowStart;
+
+    /** stream-vbyte rows: control bytes then data bytes,
+        padded so a 16 byte load never runs off the end */
+    std::vector<uint8_t> encoded;
+
+    /** bits per packed cost, -1 when costs stay in the costs array */
+    int costBits {-1};
+
+    /** costBits wide costs, edge e starts at bit e * costBits */
+    std::vector<uint64_t> packedCosts;
+
+    /** cost of edge e, wherever it is stored */
+    Cost getCost(int e) const;
+
+    /** getEdgeWeight, decoding a compressed row into row */
+    Cost findEdge(int from, int to, std::vector<int>& row) const;
+
+    /** (from id, to id, cost) collected while snapshotting */
+    struct PendingEdge {
+      int from;
+      int to;
+      Cost cost;
+    };
+    std::vector<PendingEdge> pending;
+
+    void addVertex(const Label& label);
+    void addEdge(const Label& from, const Label& to, Cost cost);
+
+    /** build offsets / targets / costs out of pending */
+    void finishEdges();
+
+    /** newId[oldId] for each ordering */
+    std::vector<int> degreeOrder() const;
+    std::vector<int> breadthFirstOrder() const;
+    std::vector<int> reverseCuthillMcKeeOrder() const;
+
+    /** neighbors in both directions, in the same offsets / targets form
+        the orderings treat edges as undirected so a vertex lands near
+        the vertices pointing at it */
+    void undirectedAdjacency(std::vector<int>& start,
+                             std::vector<int>& neighbors) const;
+
+    /** move every array to the new ids */
+    void applyPermutation(const std::vector<int>& newId);
+};
+
+/** the snapshot of the assignment's Graph */
+typedef BasicIndexedGraph<std::string, int> IndexedGraph;
+
+/** builds a compressed BasicIndexedGraph from an edge stream sorted by
+    from vertex, such as ExternalGraph::streamEdgeFile of a file sorted by
+    ExternalGraph::sortEdgeFile. Each row is encoded as soon as the next
+    one starts, so peak memory is the compressed graph, the labels and one
+    row, where the BasicGraph route holds the map nodes and the plain
+    arrays first. Ids are the vertex numbers of the stream and labels
+    their Label form, 7 or "7"; rows are sorted by id, which for string
+    labels is not label order, so traversals of "10" and "9" differ from
+    Graph's. An edge repeated in a row keeps its first cost, like
+    Graph::add, and a self loop, which Graph::add refuses, fails the
+    build */
+template <typename Label, typename Weight>
+class BasicIndexedGraphBuilder : public EdgeSink {
+ public:
+    typedef typename WeightTraits<Weight>::Cost Cost;
+
+    BasicIndexedGraphBuilder();
+
+    void begin(uint64_t vertexCount, uint64_t edgeCount) override;
+    void edge(uint32_t from, uint32_t to, int weight) override;
+    void end() override;
+
+    /** the graph, once end has been called
+        @return  nullptr, with the reason in error, if the stream was not
+                 sorted, had a self loop, a negative weight, an edge past
+                 the vertex count or more than 2^31 - 1 vertices or
+                 edges */
+    std::unique_ptr<BasicIndexedGraph<Label, Weight>> finish(
+        std::string& error);
+
+ private:
+    std::unique_ptr<BasicIndexedGraph<Label, Weight>> graph;
+    /** why the stream was refused, empty while it is fine */
+    std::string failure;
+    bool begun {false};
+    bool ended {false};
+
+    /** source of the row being collected, earlier rows are encoded */
+    uint32_t rowFrom {0};
+
+    /** (target, cost) of the row being collected, in stream order */
+    std::vector<std::pair<int, Cost>> row;
+
+    /** scratch for encoding a row */
+    std::vector<int> targets;
+
+    /** encode the collected row, then empty rows until upTo is next */
+    void finishRows(uint64_t upTo);
+
+    /** append the cost of edge e, widening the packing if it needs to */
+    void addCost(uint64_t e, Cost cost);
+};
+
+/** builder of the assignment's IndexedGraph */
+typedef BasicIndexedGraphBuilder<std::string, int> IndexedGraphBuilder;
+
+#endif  // INDEXEDGRAPH_H
@@ -0,0 +1,254 @@
+#include "kshortestpaths.h"
+
+#include <algorithm>
+#include <functional>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////
+// This is 80 characters - Keep all lines under 80 characters                 //
+////////////////////////////////////////////////////////////////////////////////
+
+/** copy the edges of graph into flat arrays
+    graph must outlive this object */
+template <typename Label, typename Weight>
+BasicKShortestPaths<Label, Weight>::BasicKShortestPaths(
+    const BasicIndexedGraph<Label, Weight>& graph)
+    : graph(graph) {
+  int n = graph.getNumVertices();
+  start.assign(n + 1, 0);
+  for (int v = 0; v < n; ++v) {
+    graph.getNeighbors(v, to, &cost);
+    start[v + 1] = static_cast<int>(to.size());
+  }
+
+  // count the in-edges of each vertex, then place them
+  backwardStart.assign(n + 1, 0);
+  for (int w : to) {
+    backwardStart[w + 1]++;
+  }
+  for (int v = 0; v < n; ++v) {
+    backwardStart[v + 1] += backwardStart[v];
+  }
+  backwardFrom.resize(to.size());
+  backwardCost.resize(to.size());
+  std::vector<int> next(backwardStart.begin(), backwardStart.end() - 1);
+  for (int v = 0; v < n; ++v) {
+    for (int e = start[v]; e < start[v + 1]; ++e) {
+      int slot = next[to[e]]++;
+      backwardFrom[slot] = v;
+      backwardCost[slot] = cost[e];
+    }
+  }
+
+  distance.assign(n, WeightTraits<Weight>::infinity());
+  toTarget.assign(n, WeightTraits<Weight>::infinity());
+  previous.assign(n, -1);
+  banned.assign(n, 0);
+}
+
+/** return up to k loopless paths from source to target, cheapest
+    first, paths of equal cost in no particular order
+    empty if there is no path or either label is missing */
+template <typename Label, typename Weight>
+std::vector<typename BasicKShortestPaths<Label, Weight>::Path>
+BasicKShortestPaths<Label, Weight>::find(const Label& source,
+                                         const Label& target, int k) {
+  const Cost infinity = WeightTraits<Weight>::infinity();
+  searches = 0;
+  int from = graph.getId(source);
+  int goal = graph.getId(target);
+  std::vector<std::pair<Cost, std::vector<int>>> chosen;
+  if (from < 0 || goal < 0 || k <= 0) {
+    return std::vector<Path>();
+  }
+
+  std::vector<int> path;
+  std::vector<int> bannedEdges;
+  searchBackward(goal);
+  ++ban;
+  Cost first = search(from, goal, bannedEdges, path);
+  if (first == infinity) {
+    return std::vector<Path>();
+  }
+  chosen.emplace_back(first, path);
+
+  // detours found so far and not chosen yet, cheapest first
+  std::set<std::pair<Cost, std::vector<int>>> candidates;
+  while (static_cast<int>(chosen.size()) < k) {
+    const std::vector<int> last = chosen.back().second;
+    Cost rootCost = Cost();
+    for (size_t spur = 0; spur + 1 < last.size(); ++spur) {
+      if (spur > 0) {
+        rootCost += edgeCost(last[spur - 1], last[spur]);
+      }
+
+      // leave by an edge no chosen path with this root took
+      bannedEdges.clear();
+      for (const auto& taken : chosen) {
+        const std::vector<int>& ids = taken.second;
+        if (ids.size() > spur + 1 &&
+            std::equal(last.begin(), last.begin() + spur + 1, ids.begin())) {
+          bannedEdges.push_back(ids[spur + 1]);
+        }
+      }
+      ++ban;
+      for (size_t r = 0; r < spur; ++r) {
+        banned[last[r]] = ban;
+      }
+      Cost spurCost = search(last[spur], goal, bannedEdges, path);
+      if (spurCost == infinity) {
+        continue;
+      }
+      std::vector<int> detour(last.begin(), last.begin() + spur);
+      detour.insert(detour.end(), path.begin(), path.end());
+      candidates.emplace(rootCost + spurCost, detour);
+    }
+    if (candidates.empty()) {
+      break;
+    }
+    chosen.push_back(*candidates.begin());
+    candidates.erase(candidates.begin());
+  }
+
+  std::vector<Path> paths(chosen.size());
+  for (size_t p = 0; p < chosen.size(); ++p) {
+    paths[p].cost = chosen[p].first;
+    for (int id : chosen[p].second) {
+      paths[p].labels.push_back(graph.getLabel(id));
+    }
+  }
+  return paths;
+}
+
+/** return the spur searches the last find ran */
+template <typename Label, typename Weight>
+int BasicKShortestPaths<Label, Weight>::getSearches() const {
+  return searches;
+}
+
+/** fill toTarget for target */
+template <typename Label, typename Weight>
+void BasicKShortestPaths<Label, Weight>::searchBackward(int target) {
+  std::fill(toTarget.begin(), toTarget.end(),
+            WeightTraits<Weight>::infinity());
+
+  // (cost to target, id) min heap, stale entries are skipped when popped
+  typedef std::pair<Cost, int> Entry;
+  std::vector<Entry> heap;
+  toTarget[target] = Cost();
+  heap.push_back(Entry(Cost(), target));
+  while (!heap.empty()) {
+    std::pop_heap(heap.begin(), heap.end(), std::greater<Entry>());
+    Entry top = heap.back();
+    heap.pop_back();
+    int v = top.second;
+    if (toTarget[v] < top.first) {
+      continue;
+    }
+    for (int e = backwardStart[v]; e < backwardStart[v + 1]; ++e) {
+      Cost through = top.first + backwardCost[e];
+      int w = backwardFrom[e];
+      if (through < toTarget[w]) {
+        toTarget[w] = through;
+        heap.push_back(Entry(through, w));
+        std::push_heap(heap.begin(), heap.end(), std::greater<Entry>());
+      }
+    }
+  }
+}
+
+/** cheapest path from source to target avoiding banned vertices and
+    the edges from source to the ids in bannedEdges, A* over toTarget
+    @return  the cost, WeightTraits<Weight>::infinity() if none,
+             with the ids of the path in path */
+template <typename Label, typename Weight>
+typename BasicKShortestPaths<Label, Weight>::Cost
+BasicKShortestPaths<Label, Weight>::search(
+    int source, int target, const std::vector<int>& bannedEdges,
+    std::vector<int>& path) {
+  const Cost infinity = WeightTraits<Weight>::infinity();
+  searches++;
+  path.clear();
+  if (toTarget[source] == infinity) {
+    return infinity;
+  }
+
+  // (cost so far plus toTarget, id) min heap, toTarget never overestimates
+  // so the target is settled at its cheapest; stale entries are skipped
+  typedef std::pair<Cost, int> Entry;
+  std::vector<Entry> heap;
+  distance[source] = Cost();
+  touched.push_back(source);
+  heap.push_back(Entry(toTarget[source], source));
+  while (!heap.empty()) {
+    std::pop_heap(heap.begin(), heap.end(), std::greater<Entry>());
+    Entry top = heap.back();
+    heap.pop_back();
+    int v = top.second;
+    if (distance[v] + toTarget[v] < top.first) {
+      continue;
+    }
+    if (v == target) {
+      break;
+    }
+    for (int e = start[v]; e < start[v + 1]; ++e) {
+      int w = to[e];
+      if (banned[w] == ban || toTarget[w] == infinity ||
+          (v == source && std::find(bannedEdges.begin(), bannedEdges.end(),
+                                    w) != bannedEdges.end())) {
+        continue;
+      }
+      Cost through = distance[v] + cost[e];
+      if (through < distance[w]) {
+        if (distance[w] == infinity) {
+          touched.push_back(w);
+        }
+        distance[w] = through;
+        previous[w] = v;
+        heap.push_back(Entry(through + toTarget[w], w));
+        std::push_heap(heap.begin(), heap.end(), std::greater<Entry>());
+      }
+    }
+  }
+
+  Cost found = distance[target];
+  if (found != infinity) {
+    for (int v = target; v != source; v = previous[v]) {
+      path.push_back(v);
+    }
+    path.push_back(source);
+    std::reverse(path.begin(), path.end());
+  }
+  for (int v : touched) {
+    distance[v] = infinity;
+    previous[v] = -1;
+  }
+  touched.clear();
+  return found;
+}
+
+/** return the cost of the edge from next, the cheapest if several */
+template <typename Label, typename Weight>
+typename BasicKShortestPaths<Label, Weight>::Cost
+BasicKShortestPaths<Label, Weight>::edgeCost(int from, int next) const {
+  Cost cheapest = WeightTraits<Weight>::infinity();
+  for (int e = start[from]; e < start[from + 1]; ++e) {
+    if (to[e] == next && cost[e] < cheapest) {
+      cheapest = cost[e];
+    }
+  }
+  return cheapest;
+}
+
+// same label and weight types as BasicGraph
+template class BasicKShortestPaths<std::string, int>;
+template class BasicKShortestPaths<std::string, long long>;
+template class BasicKShortestPaths<std::string, double>;
+template class BasicKShortestPaths<std::string, Unweighted>;
+template class BasicKShortestPaths<int, int>;
+template class BasicKShortestPaths<int, long long>;
+template class BasicKShortestPaths<int, double>;
+template class BasicKShortestPaths<int, Unweighted>;
@@ -0,0 +1,98 @@
+/**
+ * The k cheapest loopless paths between two vertices of an IndexedGraph
+ * Yen's algorithm: the cheapest path comes from Djikstra, and each later
+ * one is the cheapest detour found by leaving an earlier path at one of
+ * its vertices (the spur) with the next edge every earlier path sharing
+ * that prefix took out of the spur banned, and the prefix's vertices
+ * banned so no path loops. The detours not picked wait in a candidate set
+ * for the next round.
+ *
+ * One Djikstra backwards from the target gives every vertex its cost to
+ * the target with nothing banned. Bans only make paths dearer, so that
+ * cost never overestimates, and the spur searches are A* searches guided
+ * by it: they head straight for the target and stop when they reach it,
+ * and vertices that cannot reach the target are never looked at.
+ *
+ * Eppstein's algorithm lists paths faster, but allows paths that revisit
+ * vertices, which are no use as alternative routes.
+ */
+
+#ifndef KSHORTESTPATHS_H
+#define KSHORTESTPATHS_H
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "indexedgraph.h"
+
+template <typename Label, typename Weight>
+class BasicKShortestPaths {
+ public:
+    typedef typename WeightTraits<Weight>::Cost Cost;
+
+    /** one route, source first and target last */
+    struct Path {
+      Cost cost;
+      std::vector<Label> labels;
+    };
+
+    /** copy the edges of graph into flat arrays
+        graph must outlive this object */
+    explicit BasicKShortestPaths(
+        const BasicIndexedGraph<Label, Weight>& graph);
+
+    /** return up to k loopless paths from source to target, cheapest
+        first, paths of equal cost in no particular order
+        empty if there is no path or either label is missing */
+    std::vector<Path> find(const Label& source, const Label& target, int k);
+
+    /** return the spur searches the last find ran */
+    int getSearches() const;
+
+ private:
+    const BasicIndexedGraph<Label, Weight>& graph;
+
+    /** out-edges of each vertex: start, then neighbor ids and costs */
+    std::vector<int> start;
+    std::vector<int> to;
+    std::vector<Cost> cost;
+
+    /** in-edges of each vertex, for the search back from the target */
+    std::vector<int> backwardStart;
+    std::vector<int> backwardFrom;
+    std::vector<Cost> backwardCost;
+
+    /** cost from each vertex to the current target with nothing banned,
+        WeightTraits<Weight>::infinity() if it cannot get there */
+    std::vector<Cost> toTarget;
+
+    /** Djikstra state, reset through touched after every search */
+    std::vector<Cost> distance;
+    std::vector<int> previous;
+    std::vector<int> touched;
+
+    /** banned[v] == ban means v is off limits to the current search */
+    std::vector<int> banned;
+    int ban {0};
+
+    int searches {0};
+
+    /** fill toTarget for target */
+    void searchBackward(int target);
+
+    /** cheapest path from source to target avoiding banned vertices and
+        the edges from source to the ids in bannedEdges, A* over toTarget
+        @return  the cost, WeightTraits<Weight>::infinity() if none,
+                 with the ids of the path in path */
+    Cost search(int source, int target, const std::vector<int>& bannedEdges,
+                std::vector<int>& path);
+
+    /** return the cost of the edge from next, the cheapest if several */
+    Cost edgeCost(int from, int next) const;
+};
+
+/** k shortest paths of the assignment's Graph */
+typedef BasicKShortestPaths<std::string, int> KShortestPaths;
+
+#endif  // KSHORTESTPATHS_H
@@ -0,0 +1,455 @@
+#include "partition.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////
+// This is 80 characters - Keep all lines under 80 characters                 //
+////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+/** coarsening stops at this many vertices per part */
+const int kCoarseVerticesPerPart = 20;
+
+/** or when a round of matching merges fewer than 1 in 20 vertices */
+const double kMinShrink = 0.95;
+
+/** seeds tried when splitting the coarsest graph, it has a few dozen
+    vertices per part so tries are cheap next to the refining below */
+const int kSplitAttempts = 16;
+
+/** refinement passes per level, most levels settle in two or three */
+const int kRefinePasses = 8;
+
+/** one level of the multilevel scheme: an undirected graph whose vertices
+    and edges stand for several of the level below, weights count them */
+struct Level {
+  std::vector<int> start;
+  std::vector<int> adjacent;
+  std::vector<int> edgeWeight;
+  std::vector<int> vertexWeight;
+
+  /** the vertex of the next coarser level each vertex was merged into */
+  std::vector<int> coarse;
+
+  int size() const { return static_cast<int>(vertexWeight.size()); }
+};
+
+/** turn rows that may name a neighbor several times into rows naming it
+    once, with the weights added up */
+void mergeParallelEdges(Level& level) {
+  int n = level.size();
+  std::vector<int> slot(n, -1);
+  int kept = 0;
+  int begin = 0;
+  for (int v = 0; v < n; ++v) {
+    int rowStart = kept;
+    for (int e = begin; e < level.start[v + 1]; ++e) {
+      int w = level.adjacent[e];
+      if (slot[w] >= rowStart) {
+        level.edgeWeight[slot[w]] += level.edgeWeight[e];
+        continue;
+      }
+      slot[w] = kept;
+      level.adjacent[kept] = w;
+      level.edgeWeight[kept] = level.edgeWeight[e];
+      kept++;
+    }
+    begin = level.start[v + 1];
+    level.start[v + 1] = kept;
+  }
+  level.adjacent.resize(kept);
+  level.edgeWeight.resize(kept);
+}
+
+/** match each vertex, in random order, with the unmatched neighbor it has
+    the heaviest edge to, as long as the pair weighs at most maxWeight
+    match[v] is v for vertices left on their own; numbers the pairs in
+    fine.coarse and returns how many there are */
+int matchHeavyEdges(Level& fine, int maxWeight, std::mt19937& rng,
+                    std::vector<int>& match) {
+  int n = fine.size();
+  std::vector<int> order(n);
+  for (int v = 0; v < n; ++v) {
+    order[v] = v;
+  }
+  std::shuffle(order.begin(), order.end(), rng);
+
+  match.assign(n, -1);
+  for (int v : order) {
+    if (match[v] >= 0) {
+      continue;
+    }
+    int best = v;
+    int heaviest = 0;
+    for (int e = fine.start[v]; e < fine.start[v + 1]; ++e) {
+      int w = fine.adjacent[e];
+      if (match[w] < 0 && fine.edgeWeight[e] > heaviest &&
+          fine.vertexWeight[v] + fine.vertexWeight[w] <= maxWeight) {
+        best = w;
+        heaviest = fine.edgeWeight[e];
+      }
+    }
+    match[v] = best;
+    match[best] = v;
+  }
+
+  fine.coarse.assign(n, -1);
+  int count = 0;
+  for (int v = 0; v < n; ++v) {
+    if (fine.coarse[v] < 0) {
+      fine.coarse[v] = count;
+      fine.coarse[match[v]] = count;
+      count++;
+    }
+  }
+  return count;
+}
+
+/** the graph of fine with every matched pair merged into one vertex */
+Level contract(const Level& fine, int count, const std::vector<int>& match) {
+  Level coarse;
+  coarse.vertexWeight.assign(count, 0);
+  coarse.start.assign(count + 1, 0);
+  std::vector<int> first(count, -1);
+  for (int v = 0; v < fine.size(); ++v) {
+    int c = fine.coarse[v];
+    coarse.vertexWeight[c] += fine.vertexWeight[v];
+    if (first[c] < 0) {
+      first[c] = v;
+    }
+  }
+
+  for (int c = 0; c < count; ++c) {
+    int v = first[c];
+    int pair[2] = {v, match[v]};
+    for (int m = 0; m < (match[v] == v ? 1 : 2); ++m) {
+      for (int e = fine.start[pair[m]]; e < fine.start[pair[m] + 1]; ++e) {
+        int w = fine.coarse[fine.adjacent[e]];
+        if (w != c) {
+          coarse.adjacent.push_back(w);
+          coarse.edgeWeight.push_back(fine.edgeWeight[e]);
+        }
+      }
+    }
+    coarse.start[c + 1] = static_cast<int>(coarse.adjacent.size());
+  }
+  mergeParallelEdges(coarse);
+  return coarse;
+}
+
+/** return sum of the weights of edges between different parts, each
+    edge counted from both ends */
+int64_t cutWeight(const Level& level, const std::vector<int>& part) {
+  int64_t cut = 0;
+  for (int v = 0; v < level.size(); ++v) {
+    for (int e = level.start[v]; e < level.start[v + 1]; ++e) {
+      if (part[level.adjacent[e]] != part[v]) {
+        cut += level.edgeWeight[e];
+      }
+    }
+  }
+  return cut;
+}
+
+/** grow parts one at a time, each from a random seed, always taking the
+    unassigned vertex with the heaviest edges into the part, until it
+    holds its share of what is left; the last part takes the rest */
+void growParts(const Level& level, int parts, int maxWeight,
+               std::mt19937& rng, std::vector<int>& part) {
+  int n = level.size();
+  std::vector<int> order(n);
+  for (int v = 0; v < n; ++v) {
+    order[v] = v;
+  }
+  std::shuffle(order.begin(), order.end(), rng);
+  size_t nextSeed = 0;
+
+  int64_t left = 0;
+  for (int w : level.vertexWeight) {
+    left += w;
+  }
+  part.assign(n, parts - 1);
+  std::vector<char> placed(n, 0);
+  std::vector<int> tie(n, 0);
+  std::vector<int> touched;
+
+  // (weight of edges into the part, id) max heap, stale entries skipped
+  typedef std::pair<int, int> Entry;
+  std::vector<Entry> heap;
+  for (int p = 0; p + 1 < parts; ++p) {
+    int64_t share = (left + (parts - p) - 1) / (parts - p);
+    int64_t weight = 0;
+    while (weight < share) {
+      if (heap.empty()) {
+        while (nextSeed < order.size() && placed[order[nextSeed]]) {
+          nextSeed++;
+        }
+        if (nextSeed == order.size()) {
+          break;
+        }
+        heap.push_back(Entry(0, order[nextSeed++]));
+      }
+      std::pop_heap(heap.begin(), heap.end());
+      Entry top = heap.back();
+      heap.pop_back();
+      int v = top.second;
+      if (placed[v] || top.first < tie[v] ||
+          weight + level.vertexWeight[v] > maxWeight) {
+        continue;
+      }
+      placed[v] = 1;
+      part[v] = p;
+      weight += level.vertexWeight[v];
+      for (int e = level.start[v]; e < level.start[v + 1]; ++e) {
+        int w = level.adjacent[e];
+        if (!placed[w]) {
+          if (tie[w] == 0) {
+            touched.push_back(w);
+          }
+          tie[w] += level.edgeWeight[e];
+          heap.push_back(Entry(tie[w], w));
+          std::push_heap(heap.begin(), heap.end());
+        }
+      }
+    }
+    left -= weight;
+    heap.clear();
+    for (int w : touched) {
+      tie[w] = 0;
+    }
+    touched.clear();
+  }
+}
+
+/** move vertices to the part they have the heaviest edges into, as long
+    as that part stays within maxWeight; equal moves are made when they
+    even out the two parts, and a part above maxWeight gives vertices
+    away even at a loss. stops after a pass that moves nothing */
+void refine(const Level& level, int parts, int maxWeight,
+            std::vector<int>& part) {
+  int n = level.size();
+  std::vector<int64_t> weight(parts, 0);
+  for (int v = 0; v < n; ++v) {
+    weight[part[v]] += level.vertexWeight[v];
+  }
+
+  std::vector<int> tie(parts, 0);
+  std::vector<int> seen;
+  for (int pass = 0; pass < kRefinePasses; ++pass) {
+    int moved = 0;
+    for (int v = 0; v < n; ++v) {
+      int own = part[v];
+      int size = level.vertexWeight[v];
+      seen.clear();
+      for (int e = level.start[v]; e < level.start[v + 1]; ++e) {
+        int q = part[level.adjacent[e]];
+        if (tie[q] == 0 && q != own) {
+          seen.push_back(q);
+        }
+        tie[q] += level.edgeWeight[e];
+      }
+
+      bool over = weight[own] > maxWeight;
+      int best = -1;
+      int bestGain = std::numeric_limits<int>::min();
+      for (int q : seen) {
+        int gain = tie[q] - tie[own];
+        if (weight[q] + size <= maxWeight &&
+            (best < 0 || gain > bestGain ||
+             (gain == bestGain && weight[q] < weight[best]))) {
+          best = q;
+          bestGain = gain;
+        }
+      }
+      if (best < 0 && over) {
+        // nowhere to go next door, the lightest part takes it
+        best = static_cast<int>(std::min_element(weight.begin(),
+                                                 weight.end()) -
+                                weight.begin());
+        bestGain = -tie[own];
+        if (best == own || weight[best] + size > maxWeight) {
+          best = -1;
+        }
+      }
+      for (int q : seen) {
+        tie[q] = 0;
+      }
+      tie[own] = 0;
+
+      if (best >= 0 && (over || bestGain > 0 ||
+                        (bestGain == 0 &&
+                         weight[best] + size < weight[own]))) {
+        part[v] = best;
+        weight[own] -= size;
+        weight[best] += size;
+        moved++;
+      }
+    }
+    if (moved == 0) {
+      break;
+    }
+  }
+}
+
+/** return how far the heaviest part is above maxWeight, 0 if none is */
+int64_t overweight(const Level& level, int parts, int maxWeight,
+                   const std::vector<int>& part) {
+  std::vector<int64_t> weight(parts, 0);
+  for (int v = 0; v < level.size(); ++v) {
+    weight[part[v]] += level.vertexWeight[v];
+  }
+  return std::max<int64_t>(
+      0, *std::max_element(weight.begin(), weight.end()) - maxWeight);
+}
+
+}  // namespace
+
+/** split graph into parts parts, each at most (1 + imbalance) times
+    the average size, seed picks the matching and growing order */
+template <typename Label, typename Weight>
+BasicPartition<Label, Weight>::BasicPartition(
+    const BasicIndexedGraph<Label, Weight>& graph, int parts,
+    double imbalance, unsigned seed)
+    : graph(graph), parts(std::max(1, parts)) {
+  int n = graph.getNumVertices();
+  part.assign(n, 0);
+  sizes.assign(this->parts, 0);
+  sizes[0] = n;
+  if (this->parts == 1 || n == 0) {
+    return;
+  }
+
+  // the finest level: every edge both ways round, an edge in both
+  // directions becomes one of weight 2
+  std::vector<Level> levels(1);
+  Level& finest = levels[0];
+  finest.vertexWeight.assign(n, 1);
+  finest.start.assign(n + 1, 0);
+  std::vector<int> neighbors;
+  for (int v = 0; v < n; ++v) {
+    neighbors.clear();
+    graph.getNeighbors(v, neighbors);
+    for (int w : neighbors) {
+      finest.start[v + 1]++;
+      finest.start[w + 1]++;
+    }
+  }
+  for (int v = 0; v < n; ++v) {
+    finest.start[v + 1] += finest.start[v];
+  }
+  finest.adjacent.resize(finest.start[n]);
+  finest.edgeWeight.assign(finest.start[n], 1);
+  std::vector<int> fill(finest.start.begin(), finest.start.end() - 1);
+  for (int v = 0; v < n; ++v) {
+    neighbors.clear();
+    graph.getNeighbors(v, neighbors);
+    for (int w : neighbors) {
+      finest.adjacent[fill[v]++] = w;
+      finest.adjacent[fill[w]++] = v;
+    }
+  }
+  mergeParallelEdges(finest);
+
+  double average = static_cast<double>(n) / this->parts;
+  int maxWeight = static_cast<int>(std::ceil(average * (1 + imbalance)));
+  int coarseEnough = kCoarseVerticesPerPart * this->parts;
+  int maxVertexWeight =
+      std::max(1, static_cast<int>(3LL * n / (2 * coarseEnough)));
+  std::mt19937 rng(seed);
+
+  std::vector<int> match;
+  while (levels.back().size() > coarseEnough) {
+    int count = matchHeavyEdges(levels.back(), maxVertexWeight, rng, match);
+    if (count > kMinShrink * levels.back().size()) {
+      break;
+    }
+    Level coarser = contract(levels.back(), count, match);
+    levels.push_back(std::move(coarser));
+  }
+
+  // split the coarsest graph a few times, keep the best balanced cut
+  const Level& coarsest = levels.back();
+  std::vector<int> coarsePart;
+  std::vector<int> attempt;
+  int64_t bestOver = 0;
+  int64_t bestCut = 0;
+  for (int a = 0; a < kSplitAttempts; ++a) {
+    growParts(coarsest, this->parts, maxWeight, rng, attempt);
+    refine(coarsest, this->parts, maxWeight, attempt);
+    int64_t over = overweight(coarsest, this->parts, maxWeight, attempt);
+    int64_t cut = cutWeight(coarsest, attempt);
+    if (a == 0 || over < bestOver || (over == bestOver && cut < bestCut)) {
+      coarsePart.swap(attempt);
+      bestOver = over;
+      bestCut = cut;
+    }
+  }
+
+  // project each level's parts onto the one below and refine them there
+  for (int l = static_cast<int>(levels.size()) - 2; l >= 0; --l) {
+    const Level& fine = levels[l];
+    std::vector<int> finePart(fine.size());
+    for (int v = 0; v < fine.size(); ++v) {
+      finePart[v] = coarsePart[fine.coarse[v]];
+    }
+    refine(fine, this->parts, maxWeight, finePart);
+    coarsePart.swap(finePart);
+  }
+
+  part.swap(coarsePart);
+  sizes.assign(this->parts, 0);
+  for (int p : part) {
+    sizes[p]++;
+  }
+  edgeCut = cutWeight(levels[0], part) / 2;
+}
+
+/** return number of parts */
+template <typename Label, typename Weight>
+int BasicPartition<Label, Weight>::getNumParts() const {
+  return parts;
+}
+
+/** return the part of label, -1 if there is no such vertex */
+template <typename Label, typename Weight>
+int BasicPartition<Label, Weight>::getPart(const Label& label) const {
+  int id = graph.getId(label);
+  return id < 0 ? -1 : part[id];
+}
+
+/** part of every vertex, indexed by IndexedGraph id */
+template <typename Label, typename Weight>
+const std::vector<int>& BasicPartition<Label, Weight>::getParts() const {
+  return part;
+}
+
+/** number of vertices in each part */
+template <typename Label, typename Weight>
+const std::vector<int>& BasicPartition<Label, Weight>::getPartSizes() const {
+  return sizes;
+}
+
+/** return number of edges whose ends are in different parts,
+    an undirected edge counts twice like in getNumEdges */
+template <typename Label, typename Weight>
+int64_t BasicPartition<Label, Weight>::getEdgeCut() const {
+  return edgeCut;
+}
+
+// same label and weight types as BasicGraph
+template class BasicPartition<std::string, int>;
+template class BasicPartition<std::string, long long>;
+template class BasicPartition<std::string, double>;
+template class BasicPartition<std::string, Unweighted>;
+template class BasicPartition<int, int>;
+template class BasicPartition<int, long long>;
+template class BasicPartition<int, double>;
+template class BasicPartition<int, Unweighted>;
@@ -0,0 +1,63 @@
+/**
+ * Balanced k-way partition of an IndexedGraph with a small edge cut
+ * Multilevel, in the way of METIS, with edges taken as undirected:
+ *   coarsen   vertices are matched along their heaviest edge in random
+ *             order and each pair merged into one vertex, whose weight is
+ *             the vertices it stands for, until a few dozen per part are
+ *             left or matching stops shrinking the graph
+ *   split     parts are grown one at a time from a seed, always taking
+ *             the outside vertex most strongly tied to the part, best of a
+ *             few seeds
+ *   refine    on the way back down, boundary vertices move to the
+ *             neighboring part they have the most edges into while no
+ *             part grows past its limit, until a pass moves nothing
+ *
+ * No part holds more than (1 + imbalance) times the average number of
+ * vertices. The same graph and seed always give the same parts.
+ */
+
+#ifndef PARTITION_H
+#define PARTITION_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "indexedgraph.h"
+
+template <typename Label, typename Weight>
+class BasicPartition {
+ public:
+    /** split graph into parts parts, each at most (1 + imbalance) times
+        the average size, seed picks the matching and growing order */
+    BasicPartition(const BasicIndexedGraph<Label, Weight>& graph, int parts,
+                   double imbalance = 0.03, unsigned seed = 1);
+
+    /** return number of parts */
+    int getNumParts() const;
+
+    /** return the part of label, -1 if there is no such vertex */
+    int getPart(const Label& label) const;
+
+    /** part of every vertex, indexed by IndexedGraph id */
+    const std::vector<int>& getParts() const;
+
+    /** number of vertices in each part */
+    const std::vector<int>& getPartSizes() const;
+
+    /** return number of edges whose ends are in different parts,
+        an undirected edge counts twice like in getNumEdges */
+    int64_t getEdgeCut() const;
+
+ private:
+    const BasicIndexedGraph<Label, Weight>& graph;
+    int parts;
+    std::vector<int> part;
+    std::vector<int> sizes;
+    int64_t edgeCut {0};
+};
+
+/** partition of the assignment's Graph */
+typedef BasicPartition<std::string, int> Partition;
+
+#endif  // PARTITION_H
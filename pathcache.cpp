@@ -0,0 +1,256 @@
+#include "pathcache.h"
+
+#include <algorithm>
+#include <functional>
+#include <queue>
+#include <string>
+#include <utility>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////
+// This is 80 characters - Keep all lines under 80 characters                 //
+////////////////////////////////////////////////////////////////////////////////
+
+/** bytes counted against the budget */
+template <typename Label, typename Weight, bool Directed>
+size_t BasicPathCache<Label, Weight, Directed>::Tree::bytes() const {
+  return sizeof(Tree) + distance.capacity() * sizeof(Cost) +
+         previous.capacity() * sizeof(int);
+}
+
+/** cache trees of graph, using at most budgetBytes for them
+    graph must outlive the cache */
+template <typename Label, typename Weight, bool Directed>
+BasicPathCache<Label, Weight, Directed>::BasicPathCache(
+    const BasicGraph<Label, Weight, Directed>& graph, size_t budgetBytes)
+    : graph(&graph), budget(budgetBytes) {}
+
+/** cache trees of snapshot, which is never rebuilt, using at most
+    budgetBytes for them */
+template <typename Label, typename Weight, bool Directed>
+BasicPathCache<Label, Weight, Directed>::BasicPathCache(
+    std::shared_ptr<const Snapshot> snapshot, size_t budgetBytes)
+    : graph(nullptr), budget(budgetBytes), snapshot(std::move(snapshot)) {}
+
+/** the tree from source, nullptr if there is no such vertex
+    stays valid after eviction for as long as it is held */
+template <typename Label, typename Weight, bool Directed>
+std::shared_ptr<const typename BasicPathCache<Label, Weight, Directed>::Tree>
+BasicPathCache<Label, Weight, Directed>::getTree(const Label& source) {
+  std::shared_ptr<const Tree> tree = findTree(source);
+  if (tree) {
+    return tree;
+  }
+  int id = snapshot->getId(source);
+  if (id < 0) {
+    return nullptr;
+  }
+  tree = computeTree(snapshot, id);
+  addTree(source, tree);
+  return tree;
+}
+
+/** the cached tree from source, nullptr if it is not cached */
+template <typename Label, typename Weight, bool Directed>
+std::shared_ptr<const typename BasicPathCache<Label, Weight, Directed>::Tree>
+BasicPathCache<Label, Weight, Directed>::findTree(const Label& source) {
+  refresh();
+  auto cached = trees.find(source);
+  if (cached == trees.end()) {
+    return nullptr;
+  }
+  stats.hits++;
+  recency.splice(recency.begin(), recency, cached->second);
+  return cached->second->second;
+}
+
+/** cache tree from computeTree as the tree from source and count a
+    miss, a tree already cached for source is kept and a tree of a
+    snapshot the graph has changed since is dropped */
+template <typename Label, typename Weight, bool Directed>
+void BasicPathCache<Label, Weight, Directed>::addTree(
+    const Label& source, std::shared_ptr<const Tree> tree) {
+  refresh();
+  stats.misses++;
+  size_t size = tree->bytes();
+  // a tree that would evict everything and still not fit stays uncached
+  if (tree->snapshot != snapshot || trees.count(source) != 0 ||
+      size > budget) {
+    return;
+  }
+  while (bytes + size > budget) {
+    bytes -= recency.back().second->bytes();
+    trees.erase(recency.back().first);
+    recency.pop_back();
+    stats.evictions++;
+  }
+  recency.emplace_front(source, std::move(tree));
+  trees[source] = recency.begin();
+  bytes += size;
+}
+
+/** return the cost of the cheapest path from source to target,
+    WeightTraits<Weight>::infinity() if there is none */
+template <typename Label, typename Weight, bool Directed>
+typename BasicPathCache<Label, Weight, Directed>::Cost
+BasicPathCache<Label, Weight, Directed>::getCost(const Label& source,
+                                                 const Label& target) {
+  std::shared_ptr<const Tree> tree = getTree(source);
+  int id = snapshot->getId(target);
+  if (!tree || id < 0) {
+    return WeightTraits<Weight>::infinity();
+  }
+  return tree->distance[id];
+}
+
+/** return the labels on the cheapest path, source first and target
+    last, empty if there is no path */
+template <typename Label, typename Weight, bool Directed>
+std::vector<Label> BasicPathCache<Label, Weight, Directed>::getPath(
+    const Label& source, const Label& target) {
+  std::vector<Label> path;
+  std::shared_ptr<const Tree> tree = getTree(source);
+  int id = snapshot->getId(target);
+  if (!tree || id < 0 ||
+      tree->distance[id] == WeightTraits<Weight>::infinity()) {
+    return path;
+  }
+  for (; id >= 0; id = tree->previous[id]) {
+    path.push_back(snapshot->getLabel(id));
+  }
+  std::reverse(path.begin(), path.end());
+  return path;
+}
+
+/** fill weight and previous like Graph::djikstraCostToAllVertices,
+    without printing the report
+    where two paths cost the same, previous may pick the other one */
+template <typename Label, typename Weight, bool Directed>
+void BasicPathCache<Label, Weight, Directed>::djikstraCostToAllVertices(
+    const Label& startLabel, std::map<Label, Cost>& weight,
+    std::map<Label, Label>& previous) {
+  weight.clear();
+  previous.clear();
+  std::shared_ptr<const Tree> tree = getTree(startLabel);
+  if (!tree) {
+    return;
+  }
+  for (int v = 0; v < snapshot->getNumVertices(); ++v) {
+    if (tree->previous[v] >= 0) {
+      weight[snapshot->getLabel(v)] = tree->distance[v];
+      previous[snapshot->getLabel(v)] =
+          snapshot->getLabel(tree->previous[v]);
+    }
+  }
+}
+
+/** the snapshot tree ids refer to, rebuilt after the graph changes
+    the old one lives on for as long as it or a tree of it is held */
+template <typename Label, typename Weight, bool Directed>
+std::shared_ptr<const BasicIndexedGraph<Label, Weight>>
+BasicPathCache<Label, Weight, Directed>::getSnapshot() {
+  refresh();
+  return snapshot;
+}
+
+/** hit, miss, eviction and invalidation counts */
+template <typename Label, typename Weight, bool Directed>
+const PathCacheStats& BasicPathCache<Label, Weight, Directed>::getStats()
+    const {
+  return stats;
+}
+
+/** return bytes held by cached trees */
+template <typename Label, typename Weight, bool Directed>
+size_t BasicPathCache<Label, Weight, Directed>::getBytes() const {
+  return bytes;
+}
+
+/** return number of cached trees */
+template <typename Label, typename Weight, bool Directed>
+int BasicPathCache<Label, Weight, Directed>::getNumTrees() const {
+  return static_cast<int>(trees.size());
+}
+
+/** drop every tree, the counters are kept */
+template <typename Label, typename Weight, bool Directed>
+void BasicPathCache<Label, Weight, Directed>::clear() {
+  recency.clear();
+  trees.clear();
+  bytes = 0;
+}
+
+/** rebuild the snapshot if the graph changed since it was taken,
+    nothing for a fixed snapshot */
+template <typename Label, typename Weight, bool Directed>
+void BasicPathCache<Label, Weight, Directed>::refresh() {
+  if (!graph || (snapshot && version == graph->getVersion())) {
+    return;
+  }
+  if (snapshot) {
+    stats.invalidations++;
+  }
+  clear();
+  snapshot = std::make_shared<Snapshot>(*graph);
+  version = graph->getVersion();
+}
+
+/** Djikstra from id source of snapshot, from getSnapshot, the cache
+    is left alone, so it needs no lock */
+template <typename Label, typename Weight, bool Directed>
+std::shared_ptr<const typename BasicPathCache<Label, Weight, Directed>::Tree>
+BasicPathCache<Label, Weight, Directed>::computeTree(
+    std::shared_ptr<const Snapshot> snapshot, int source) {
+  int n = snapshot->getNumVertices();
+  std::shared_ptr<Tree> tree = std::make_shared<Tree>();
+  tree->snapshot = snapshot;
+  tree->distance.assign(n, WeightTraits<Weight>::infinity());
+  tree->previous.assign(n, -1);
+  tree->distance[source] = Cost();
+
+  // (cost so far, id), stale entries are skipped when popped
+  typedef std::pair<Cost, int> Entry;
+  std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> queue;
+  queue.push(Entry(Cost(), source));
+  std::vector<int> neighbors;
+  std::vector<Cost> costs;
+  while (!queue.empty()) {
+    Entry top = queue.top();
+    queue.pop();
+    int v = top.second;
+    if (tree->distance[v] < top.first) {
+      continue;
+    }
+    neighbors.clear();
+    costs.clear();
+    snapshot->getNeighbors(v, neighbors, &costs);
+    for (size_t i = 0; i < neighbors.size(); ++i) {
+      Cost through = top.first + costs[i];
+      int w = neighbors[i];
+      if (through < tree->distance[w]) {
+        tree->distance[w] = through;
+        tree->previous[w] = v;
+        queue.push(Entry(through, w));
+      }
+    }
+  }
+  return tree;
+}
+
+// same label, weight and direction combinations as BasicGraph
+template class BasicPathCache<std::string, int, true>;
+template class BasicPathCache<std::string, long long, true>;
+template class BasicPathCache<std::string, double, true>;
+template class BasicPathCache<std::string, Unweighted, true>;
+template class BasicPathCache<int, int, true>;
+template class BasicPathCache<int, long long, true>;
+template class BasicPathCache<int, double, true>;
+template class BasicPathCache<int, Unweighted, true>;
+template class BasicPathCache<std::string, int, false>;
+template class BasicPathCache<std::string, long long, false>;
+template class BasicPathCache<std::string, double, false>;
+template class BasicPathCache<std::string, Unweighted, false>;
+template class BasicPathCache<int, int, false>;
+template class BasicPathCache<int, long long, false>;
+template class BasicPathCache<int, double, false>;
+template class BasicPathCache<int, Unweighted, false>;
@@ -0,0 +1,156 @@
+/**
+ * Cache of shortest-path trees, keyed by source vertex
+ * A miss runs Djikstra from the source over an IndexedGraph snapshot of
+ * the graph and keeps the whole tree as two arrays indexed by snapshot id:
+ * the cost to every vertex and the vertex before it on the path. Every
+ * later query from that source is an array lookup.
+ *
+ * Trees are evicted least recently used first once their arrays would
+ * take more than the memory budget. The cache compares Graph::getVersion
+ * on every query; after an add it drops every tree and the snapshot.
+ * A cache can instead be given an IndexedGraph already shared with other
+ * code, which it uses as is and never rebuilds, so no second copy of the
+ * graph is made.
+ * Not thread safe, callers sharing a cache need their own lock. They can
+ * hold it just for getSnapshot, findTree and addTree and run computeTree
+ * outside it, so misses from several threads run Djikstra at the same
+ * time. A tree holds the snapshot it was computed from, so a rebuild
+ * cannot free it under a running computeTree, and addTree refuses a tree
+ * from a snapshot the cache has since replaced.
+ */
+
+#ifndef PATHCACHE_H
+#define PATHCACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "graph.h"
+#include "indexedgraph.h"
+
+/** how the cache has been doing since it was made */
+struct PathCacheStats {
+  /** queries answered from a cached tree */
+  uint64_t hits {0};
+
+  /** queries that had to run Djikstra */
+  uint64_t misses {0};
+
+  /** trees dropped to stay under the memory budget */
+  uint64_t evictions {0};
+
+  /** times a change to the graph dropped every tree */
+  uint64_t invalidations {0};
+};
+
+template <typename Label, typename Weight, bool Directed>
+class BasicPathCache {
+ public:
+    typedef typename WeightTraits<Weight>::Cost Cost;
+    typedef BasicIndexedGraph<Label, Weight> Snapshot;
+
+    /** every shortest path from one source, indexed by snapshot id
+        distance is WeightTraits<Weight>::infinity() and previous is -1
+        for vertices the source cannot reach, previous is also -1 for
+        the source itself */
+    struct Tree {
+      std::vector<Cost> distance;
+      std::vector<int> previous;
+
+      /** the snapshot the ids refer to, kept for as long as the tree */
+      std::shared_ptr<const Snapshot> snapshot;
+
+      /** bytes counted against the budget */
+      size_t bytes() const;
+    };
+
+    /** cache trees of graph, using at most budgetBytes for them
+        graph must outlive the cache */
+    explicit BasicPathCache(const BasicGraph<Label, Weight, Directed>& graph,
+                            size_t budgetBytes = size_t(64) << 20);
+
+    /** cache trees of snapshot, which is never rebuilt, using at most
+        budgetBytes for them */
+    explicit BasicPathCache(std::shared_ptr<const Snapshot> snapshot,
+                            size_t budgetBytes = size_t(64) << 20);
+
+    /** the tree from source, nullptr if there is no such vertex
+        stays valid after eviction for as long as it is held */
+    std::shared_ptr<const Tree> getTree(const Label& source);
+
+    /** the cached tree from source, nullptr if it is not cached */
+    std::shared_ptr<const Tree> findTree(const Label& source);
+
+    /** Djikstra from id source of snapshot, from getSnapshot, the cache
+        is left alone, so it needs no lock */
+    static std::shared_ptr<const Tree> computeTree(
+        std::shared_ptr<const Snapshot> snapshot, int source);
+
+    /** cache tree from computeTree as the tree from source and count a
+        miss, a tree already cached for source is kept and a tree of a
+        snapshot the graph has changed since is dropped */
+    void addTree(const Label& source, std::shared_ptr<const Tree> tree);
+
+    /** return the cost of the cheapest path from source to target,
+        WeightTraits<Weight>::infinity() if there is none */
+    Cost getCost(const Label& source, const Label& target);
+
+    /** return the labels on the cheapest path, source first and target
+        last, empty if there is no path */
+    std::vector<Label> getPath(const Label& source, const Label& target);
+
+    /** fill weight and previous like Graph::djikstraCostToAllVertices,
+        without printing the report
+        where two paths cost the same, previous may pick the other one */
+    void djikstraCostToAllVertices(const Label& startLabel,
+                                   std::map<Label, Cost>& weight,
+                                   std::map<Label, Label>& previous);
+
+    /** the snapshot tree ids refer to, rebuilt after the graph changes
+        the old one lives on for as long as it or a tree of it is held */
+    std::shared_ptr<const Snapshot> getSnapshot();
+
+    /** hit, miss, eviction and invalidation counts */
+    const PathCacheStats& getStats() const;
+
+    /** return bytes held by cached trees */
+    size_t getBytes() const;
+
+    /** return number of cached trees */
+    int getNumTrees() const;
+
+    /** drop every tree, the counters are kept */
+    void clear();
+
+ private:
+    /** the graph snapshots are taken of, nullptr for a fixed snapshot */
+    const BasicGraph<Label, Weight, Directed>* graph;
+    size_t budget;
+
+    /** graph version the snapshot and trees were built from */
+    uint64_t version {0};
+    std::shared_ptr<const Snapshot> snapshot;
+
+    /** most recently used first */
+    typedef std::list<std::pair<Label, std::shared_ptr<const Tree>>> Recency;
+    Recency recency;
+    std::unordered_map<Label, typename Recency::iterator> trees;
+    size_t bytes {0};
+
+    PathCacheStats stats;
+
+    /** rebuild the snapshot if the graph changed since it was taken,
+        nothing for a fixed snapshot */
+    void refresh();
+};
+
+/** path cache of the assignment's Graph */
+typedef BasicPathCache<std::string, int, true> PathCache;
+
+#endif  // PATHCACHE_H
@@ -0,0 +1,17 @@
+/**
+ * Hint that memory is about to be read, so the load can start early
+ * Compiles to nothing where the compiler has no prefetch builtin
+ */
+
+#ifndef PREFETCH_H
+#define PREFETCH_H
+
+inline void prefetch(const void* address) {
+#if defined(__GNUC__) || defined(__clang__)
+  __builtin_prefetch(address);
+#else
+  (void)address;
+#endif
+}
+
+#endif  // PREFETCH_H
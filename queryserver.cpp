@@ -0,0 +1,842 @@
+#include "queryserver.h"
+
+#ifndef _WIN32
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////
+// This is 80 characters - Keep all lines under 80 characters                 //
+////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+/** a client sending this much without a newline is dropped */
+const size_t kMaxLine = 64 * 1024;
+
+/** a client that takes none of its waiting answers for this long is
+    dropped, so they do not pile up */
+const int kSendTimeoutSeconds = 5;
+
+/** a client with more answer bytes than this waiting is not read from
+    until it takes some */
+const size_t kMaxPending = 1024 * 1024;
+
+/** a client with this many requests read and not answered yet is not
+    read from until some are answered, so answers waiting behind a slow
+    one, BUSY included, do not pile up either */
+const uint64_t kMaxUnanswered = 4096;
+
+/** where the visitor of the traversal running on this thread appends */
+thread_local std::string* visited = nullptr;
+
+void appendLabel(const std::string& label) {
+  *visited += ' ';
+  *visited += label;
+}
+
+/** send every byte, false if the connection failed */
+bool sendAll(int socket, const std::string& bytes) {
+  size_t sent = 0;
+  while (sent < bytes.size()) {
+    ssize_t count = send(socket, bytes.data() + sent, bytes.size() - sent,
+                         MSG_NOSIGNAL);
+    if (count < 0 && errno == EINTR) {
+      continue;
+    }
+    if (count <= 0) {
+      return false;
+    }
+    sent += count;
+  }
+  return true;
+}
+
+/** the first four whitespace separated words of line, missing ones are
+    left empty */
+void splitWords(const std::string& line, std::string words[4]) {
+  size_t end = 0;
+  for (int w = 0; w < 4; ++w) {
+    size_t begin = line.find_first_not_of(" \t", end);
+    if (begin == std::string::npos) {
+      words[w].clear();
+      continue;
+    }
+    end = std::min(line.find_first_of(" \t", begin), line.size());
+    words[w].assign(line, begin, end - begin);
+  }
+}
+
+bool socketAddress(const std::string& path, sockaddr_un& address,
+                   std::string& error) {
+  std::memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  if (path.empty() || path.size() >= sizeof(address.sun_path)) {
+    error = "socket path must be 1 to " +
+            std::to_string(sizeof(address.sun_path) - 1) + " characters";
+    return false;
+  }
+  std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+  return true;
+}
+
+}  // namespace
+
+////////////////////////////////////////////////////////////////////////////////
+// LatencyHistogram                                                           //
+////////////////////////////////////////////////////////////////////////////////
+
+LatencyHistogram::LatencyHistogram() {
+  for (std::atomic<uint64_t>& bucket : buckets) {
+    bucket.store(0, std::memory_order_relaxed);
+  }
+}
+
+/** count one latency */
+void LatencyHistogram::record(int64_t micros) {
+  uint64_t value = static_cast<uint64_t>(std::max<int64_t>(micros, 0)) + 1;
+  int bucket = 0;
+  while (value > 1 && bucket < kBuckets - 1) {
+    value >>= 1;
+    ++bucket;
+  }
+  buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+}
+
+/** return number of latencies recorded */
+uint64_t LatencyHistogram::getCount() const {
+  uint64_t count = 0;
+  for (const std::atomic<uint64_t>& bucket : buckets) {
+    count += bucket.load(std::memory_order_relaxed);
+  }
+  return count;
+}
+
+/** return the upper end of the bucket holding the fraction-th
+    latency, e.g. percentile(0.99), 0 if nothing was recorded */
+int64_t LatencyHistogram::percentile(double fraction) const {
+  uint64_t count = getCount();
+  if (count == 0) {
+    return 0;
+  }
+  uint64_t rank = static_cast<uint64_t>(std::ceil(fraction * count));
+  rank = std::max<uint64_t>(1, std::min(rank, count));
+  uint64_t seen = 0;
+  for (int b = 0; b < kBuckets; ++b) {
+    seen += buckets[b].load(std::memory_order_relaxed);
+    if (seen >= rank) {
+      return (int64_t(1) << (b + 1)) - 1;
+    }
+  }
+  return (int64_t(1) << kBuckets) - 1;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// QueryServer                                                                //
+////////////////////////////////////////////////////////////////////////////////
+
+/** one client, shared by the poll loop and the requests still queued
+    from it, the socket is closed when the last of them lets go */
+struct QueryServer::Connection {
+  int socket;
+
+  /** bytes after the last complete request line, poll loop only */
+  std::string buffered;
+
+  /** sequence number of the next request read, written by the poll loop
+      only, no longer changes once ended is set */
+  uint64_t received {0};
+
+  /** guards everything below */
+  std::mutex writeLock;
+
+  /** sequence number of the next answer to write */
+  uint64_t written {0};
+
+  /** answers finished before an earlier one, by sequence number */
+  std::map<uint64_t, std::string> finished;
+
+  /** answers the socket did not take yet */
+  std::string pending;
+
+  /** when pending last got shorter or stopped being empty */
+  std::chrono::steady_clock::time_point progress;
+
+  /** a send failed, later answers are dropped */
+  bool broken {false};
+
+  /** the client shut down its end, no more requests will come; the poll
+      loop closes the connection once every answer has been sent */
+  bool ended {false};
+
+  /** the poll loop stopped reading for kMaxUnanswered, the next answer
+      written wakes it */
+  bool paused {false};
+
+  explicit Connection(int socket) : socket(socket) {}
+  ~Connection() { close(socket); }
+
+  /** send what the socket takes of pending without blocking */
+  void flush() {
+    size_t sent = 0;
+    while (sent < pending.size()) {
+      ssize_t count = send(socket, pending.data() + sent,
+                           pending.size() - sent,
+                           MSG_NOSIGNAL | MSG_DONTWAIT);
+      if (count < 0 && errno == EINTR) {
+        continue;
+      }
+      if (count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+        break;
+      }
+      if (count <= 0) {
+        drop();
+        return;
+      }
+      sent += count;
+    }
+    if (sent > 0) {
+      pending.erase(0, sent);
+      progress = std::chrono::steady_clock::now();
+    }
+  }
+
+  /** give up on the client, the poll loop sees the shutdown and lets go
+      of it */
+  void drop() {
+    broken = true;
+    pending.clear();
+    shutdown(socket, SHUT_RDWR);
+  }
+};
+
+struct QueryServer::Request {
+  std::shared_ptr<Connection> connection;
+  uint64_t sequence;
+  std::string line;
+  std::chrono::steady_clock::time_point arrival;
+};
+
+/** snapshot graph, which is not used after the constructor */
+QueryServer::QueryServer(const Graph& graph, const ServerOptions& options)
+    : options(options),
+      snapshot(std::make_shared<IndexedGraph>(graph)),
+      edges(*snapshot),
+      paths(snapshot, options.cacheBytes) {
+  this->options.maxBatch = std::max<size_t>(1, options.maxBatch);
+}
+
+/** stops the server if it is running */
+QueryServer::~QueryServer() { stop(); }
+
+/** create the socket and start the threads
+    @return  false, with the reason in error, if the socket failed */
+bool QueryServer::start(std::string& error) {
+  if (started) {
+    error = "already started";
+    return false;
+  }
+  sockaddr_un address;
+  if (!socketAddress(options.socketPath, address, error)) {
+    return false;
+  }
+  unlink(options.socketPath.c_str());
+  listener = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (listener < 0 ||
+      bind(listener, reinterpret_cast<sockaddr*>(&address),
+           sizeof(address)) != 0 ||
+      listen(listener, 128) != 0 || pipe(wake) != 0 ||
+      fcntl(wake[0], F_SETFL, O_NONBLOCK) != 0 ||
+      fcntl(wake[1], F_SETFL, O_NONBLOCK) != 0) {
+    error = std::string("cannot listen on ") + options.socketPath + ": " +
+            std::strerror(errno);
+    if (listener >= 0) {
+      close(listener);
+      listener = -1;
+    }
+    if (wake[0] >= 0) {
+      close(wake[0]);
+      close(wake[1]);
+      wake[0] = wake[1] = -1;
+    }
+    unlink(options.socketPath.c_str());
+    return false;
+  }
+
+  stopping = false;
+  closing = false;
+  started = true;
+  int count = options.workers;
+  if (count <= 0) {
+    count = std::max(1u, std::thread::hardware_concurrency());
+  }
+  for (int w = 0; w < count; ++w) {
+    workers.emplace_back(&QueryServer::work, this);
+  }
+  poller = std::thread(&QueryServer::serve, this);
+  return true;
+}
+
+/** answer what is queued, stop every thread, remove the socket */
+void QueryServer::stop() {
+  if (!started) {
+    return;
+  }
+  // the workers drain the queue while the poll loop answers new requests
+  // BUSY, then the poll loop writes what the sockets have not taken yet
+  {
+    std::lock_guard<std::mutex> lock(queueLock);
+    stopping = true;
+  }
+  ready.notify_all();
+  for (std::thread& worker : workers) {
+    worker.join();
+  }
+  workers.clear();
+  closing = true;
+  wakePoller();
+  poller.join();
+
+  close(listener);
+  close(wake[0]);
+  close(wake[1]);
+  listener = wake[0] = wake[1] = -1;
+  unlink(options.socketPath.c_str());
+  started = false;
+}
+
+/** answer request lines without a socket, the way a worker does */
+std::vector<std::string> QueryServer::handleBatch(
+    const std::vector<std::string>& requests) {
+  std::vector<std::string> answers(requests.size());
+
+  // the lookups of one kind run together once the batch is sorted out
+  std::vector<size_t> weightAt;
+  std::vector<std::pair<int, int>> weightPairs;
+  std::vector<size_t> pathAt;
+  std::vector<std::pair<std::string, std::string>> pathEnds;
+
+  std::string words[4];
+  const std::string& command = words[0];
+  const std::string& first = words[1];
+  const std::string& second = words[2];
+  for (size_t i = 0; i < requests.size(); ++i) {
+    splitWords(requests[i], words);
+    const std::string& extra = words[3];
+    bool one = !first.empty() && second.empty();
+    bool two = !second.empty() && extra.empty();
+    if ((command == "BFS" || command == "DFS") && one) {
+      answers[i] = traverse(first, command == "BFS");
+    } else if (command == "WEIGHT" && two) {
+      weightAt.push_back(i);
+      weightPairs.emplace_back(snapshot->getId(first),
+                               snapshot->getId(second));
+    } else if (command == "PATH" && two) {
+      pathAt.push_back(i);
+      pathEnds.emplace_back(first, second);
+    } else if (command == "STATS" && first.empty()) {
+      answers[i] = statsLine();
+    } else {
+      answers[i] = "ERR unknown request: " + requests[i];
+    }
+  }
+
+  if (!weightPairs.empty()) {
+    std::vector<EdgeIndex::Cost> weights;
+    edges.getEdgeWeights(weightPairs, weights);
+    for (size_t k = 0; k < weightAt.size(); ++k) {
+      answers[weightAt[k]] =
+          weights[k] == WeightTraits<int>::infinity()
+              ? "NONE" : "OK " + std::to_string(weights[k]);
+    }
+  }
+
+  if (!pathEnds.empty()) {
+    // the lock covers only the cache lookups and inserts, trees that
+    // missed are computed outside it so workers run Djikstra side by side
+    std::vector<std::shared_ptr<const PathCache::Tree>> trees(pathAt.size());
+    {
+      std::lock_guard<std::mutex> lock(pathLock);
+      for (size_t k = 0; k < pathAt.size(); ++k) {
+        trees[k] = paths.findTree(pathEnds[k].first);
+      }
+    }
+    const IndexedGraph& ids = *snapshot;
+    std::map<std::string, std::shared_ptr<const PathCache::Tree>> computed;
+    for (size_t k = 0; k < pathAt.size(); ++k) {
+      int source = ids.getId(pathEnds[k].first);
+      if (trees[k] || source < 0) {
+        continue;
+      }
+      std::shared_ptr<const PathCache::Tree>& tree =
+          computed[pathEnds[k].first];
+      if (!tree) {
+        tree = PathCache::computeTree(snapshot, source);
+      }
+      trees[k] = tree;
+    }
+    if (!computed.empty()) {
+      std::lock_guard<std::mutex> lock(pathLock);
+      for (const auto& entry : computed) {
+        paths.addTree(entry.first, entry.second);
+      }
+    }
+
+    for (size_t k = 0; k < pathAt.size(); ++k) {
+      const std::shared_ptr<const PathCache::Tree>& tree = trees[k];
+      int target = ids.getId(pathEnds[k].second);
+      if (!tree || target < 0 ||
+          tree->distance[target] == WeightTraits<int>::infinity()) {
+        answers[pathAt[k]] = "NONE";
+        continue;
+      }
+      std::vector<int> path;
+      for (int v = target; v >= 0; v = tree->previous[v]) {
+        path.push_back(v);
+      }
+      std::string answer = "OK " + std::to_string(tree->distance[target]);
+      for (size_t p = path.size(); p-- > 0;) {
+        answer += ' ';
+        answer += ids.getLabel(path[p]);
+      }
+      answers[pathAt[k]] = answer;
+    }
+  }
+  return answers;
+}
+
+/** counters and latency percentiles so far */
+ServerStats QueryServer::getStats() const {
+  ServerStats stats;
+  stats.requests = requests.load();
+  stats.batches = batches.load();
+  stats.rejected = rejected.load();
+  stats.connections = connections.load();
+  stats.p50Micros = latency.percentile(0.50);
+  stats.p90Micros = latency.percentile(0.90);
+  stats.p99Micros = latency.percentile(0.99);
+  return stats;
+}
+
+/** poll loop: accept clients, read lines, queue requests, write the
+    answers sockets did not take at once */
+void QueryServer::serve() {
+  std::vector<std::shared_ptr<Connection>> clients;
+  std::vector<std::shared_ptr<Connection>> open;
+  std::vector<pollfd> watched;
+  char chunk[4096];
+  bool draining = false;
+  for (;;) {
+    // clients with answers waiting are watched for POLLOUT and dropped
+    // once they take none for kSendTimeoutSeconds, clients with too many
+    // answers waiting or requests unanswered are not read from; while
+    // draining nothing is read or accepted
+    // a client that shut down its end is only written to, and stays,
+    // left out of poll, while its requests are still being answered
+    std::chrono::steady_clock::time_point now =
+        std::chrono::steady_clock::now();
+    bool waiting = false;
+    watched.assign(2, pollfd());
+    watched[0].fd = wake[0];
+    watched[0].events = POLLIN;
+    watched[1].fd = draining ? -1 : listener;
+    watched[1].events = POLLIN;
+    open.clear();
+    for (const std::shared_ptr<Connection>& client : clients) {
+      pollfd entry = pollfd();
+      entry.fd = client->socket;
+      std::lock_guard<std::mutex> lock(client->writeLock);
+      if (!client->pending.empty() &&
+          now - client->progress >
+              std::chrono::seconds(kSendTimeoutSeconds)) {
+        client->drop();
+      }
+      if (!client->pending.empty()) {
+        entry.events |= POLLOUT;
+        waiting = true;
+      }
+      client->paused =
+          client->received - client->written >= kMaxUnanswered;
+      if (!draining && !client->ended && !client->paused &&
+          client->pending.size() <= kMaxPending) {
+        entry.events |= POLLIN;
+      }
+      bool unanswered =
+          !client->broken && client->written < client->received;
+      if (entry.events == 0 && unanswered) {
+        entry.fd = -1;
+      }
+      if (entry.events != 0 || unanswered) {
+        open.push_back(client);
+        watched.push_back(entry);
+      }
+    }
+    // what was let go must not be held while poll waits, the socket
+    // closes with the last reference
+    clients.swap(open);
+    open.clear();
+    if (draining && clients.empty()) {
+      return;
+    }
+    if (poll(watched.data(), watched.size(), waiting ? 1000 : -1) < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return;
+    }
+    if (watched[0].revents != 0) {
+      while (read(wake[0], chunk, sizeof(chunk)) > 0) {
+      }
+      draining = closing;
+    }
+
+    if (watched[1].revents & POLLIN) {
+      int socket = accept(listener, nullptr, nullptr);
+      if (socket >= 0) {
+        clients.push_back(std::make_shared<Connection>(socket));
+        connections++;
+      }
+    }
+
+    // clients accepted above were not polled yet, they start at index 2
+    open.clear();
+    for (size_t c = 0; c + 2 < watched.size(); ++c) {
+      std::shared_ptr<Connection>& client = clients[c];
+      const pollfd& entry = watched[c + 2];
+      // a send to a client that hung up fails and drops it
+      if (entry.revents & (POLLOUT | POLLHUP | POLLERR)) {
+        std::lock_guard<std::mutex> lock(client->writeLock);
+        client->flush();
+      }
+      if (!(entry.events & POLLIN) ||
+          !(entry.revents & (POLLIN | POLLHUP | POLLERR))) {
+        open.push_back(client);
+        continue;
+      }
+      ssize_t count = recv(client->socket, chunk, sizeof(chunk), 0);
+      if (count < 0 && errno == EINTR) {
+        open.push_back(client);
+        continue;
+      }
+      if (count == 0) {
+        std::lock_guard<std::mutex> lock(client->writeLock);
+        client->ended = true;
+        open.push_back(client);
+        continue;
+      }
+      if (count < 0) {
+        continue;
+      }
+      client->buffered.append(chunk, count);
+      size_t begin = 0;
+      size_t end;
+      while ((end = client->buffered.find('\n', begin)) !=
+             std::string::npos) {
+        std::string line = client->buffered.substr(begin, end - begin);
+        begin = end + 1;
+        if (!line.empty() && line.back() == '\r') {
+          line.pop_back();
+        }
+        if (line.empty()) {
+          continue;
+        }
+        submit(Request {client, client->received++, std::move(line),
+                        std::chrono::steady_clock::now()});
+      }
+      client->buffered.erase(0, begin);
+      if (client->buffered.size() <= kMaxLine) {
+        open.push_back(client);
+      }
+    }
+    for (size_t c = watched.size() - 2; c < clients.size(); ++c) {
+      open.push_back(clients[c]);
+    }
+    clients.swap(open);
+  }
+}
+
+/** worker loop: take a batch, answer it */
+void QueryServer::work() {
+  std::vector<Request> batch;
+  std::vector<std::string> lines;
+  for (;;) {
+    {
+      std::unique_lock<std::mutex> lock(queueLock);
+      ready.wait(lock, [this] { return stopping || !queue.empty(); });
+      if (queue.empty()) {
+        return;
+      }
+      size_t take = std::min(queue.size(), options.maxBatch);
+      batch.assign(std::make_move_iterator(queue.begin()),
+                   std::make_move_iterator(queue.begin() + take));
+      queue.erase(queue.begin(), queue.begin() + take);
+    }
+    batches++;
+    lines.clear();
+    for (const Request& request : batch) {
+      lines.push_back(request.line);
+    }
+    std::vector<std::string> answers = handleBatch(lines);
+    for (size_t i = 0; i < batch.size(); ++i) {
+      reply(batch[i], answers[i]);
+    }
+    // let go of the connections before waiting for the next batch
+    batch.clear();
+  }
+}
+
+/** queue a request, or answer BUSY when the queue is full or the
+    server is stopping */
+void QueryServer::submit(Request&& request) {
+  requests++;
+  {
+    std::lock_guard<std::mutex> lock(queueLock);
+    if (!stopping && queue.size() < options.queueCapacity) {
+      queue.push_back(std::move(request));
+      ready.notify_one();
+      return;
+    }
+  }
+  rejected++;
+  reply(request, "BUSY");
+}
+
+/** send the answer once every earlier answer on its connection
+    has been sent, without blocking, and record its latency */
+void QueryServer::reply(const Request& request, const std::string& answer) {
+  Connection& connection = *request.connection;
+  std::lock_guard<std::mutex> lock(connection.writeLock);
+  connection.finished[request.sequence] = answer;
+  std::string written;
+  for (auto next = connection.finished.find(connection.written);
+       next != connection.finished.end();
+       next = connection.finished.find(connection.written)) {
+    written += next->second;
+    written += '\n';
+    connection.finished.erase(next);
+    connection.written++;
+  }
+  if (!written.empty() && !connection.broken) {
+    bool idle = connection.pending.empty();
+    if (idle) {
+      connection.progress = std::chrono::steady_clock::now();
+    }
+    connection.pending += written;
+    connection.flush();
+    // the poll loop only watches for POLLOUT when it finds pending answers
+    if (idle && !connection.pending.empty()) {
+      wakePoller();
+    }
+  }
+  // a client that shut down its end is closed by the poll loop once it
+  // has every answer, which it may just have been given, and a paused
+  // one is read from again
+  if (!written.empty() &&
+      (connection.paused || (connection.ended &&
+                             connection.written == connection.received))) {
+    connection.paused = false;
+    wakePoller();
+  }
+  latency.record(std::chrono::duration_cast<std::chrono::microseconds>(
+                     std::chrono::steady_clock::now() - request.arrival)
+                     .count());
+}
+
+/** make the poll loop look at its connections again */
+void QueryServer::wakePoller() {
+  // a full pipe already wakes the poll loop
+  char byte = 0;
+  while (write(wake[1], &byte, 1) < 0 && errno == EINTR) {
+  }
+}
+
+/** "OK " and the labels in visit order, NONE if no such vertex */
+std::string QueryServer::traverse(const std::string& start,
+                                  bool breadthFirst) const {
+  if (snapshot->getId(start) < 0) {
+    return "NONE";
+  }
+  std::string answer = "OK";
+  visited = &answer;
+  if (breadthFirst) {
+    snapshot->breadthFirstTraversal(start, appendLabel);
+  } else {
+    snapshot->depthFirstTraversal(start, appendLabel);
+  }
+  visited = nullptr;
+  return answer;
+}
+
+std::string QueryServer::statsLine() const {
+  ServerStats stats = getStats();
+  std::ostringstream line;
+  line << "OK requests=" << stats.requests << " batches=" << stats.batches
+       << " rejected=" << stats.rejected
+       << " connections=" << stats.connections
+       << " p50_us=" << stats.p50Micros << " p90_us=" << stats.p90Micros
+       << " p99_us=" << stats.p99Micros;
+  return line.str();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// QueryClient                                                                //
+////////////////////////////////////////////////////////////////////////////////
+
+QueryClient::QueryClient() {}
+
+/** closes the connection */
+QueryClient::~QueryClient() {
+  if (socket >= 0) {
+    close(socket);
+  }
+}
+
+/** connect to the server listening on socketPath
+    @return  false, with the reason in error, if it failed */
+bool QueryClient::connect(const std::string& socketPath,
+                          std::string& error) {
+  sockaddr_un address;
+  if (!socketAddress(socketPath, address, error)) {
+    return false;
+  }
+  if (socket >= 0) {
+    close(socket);
+  }
+  buffered.clear();
+  socket = ::socket(AF_UNIX, SOCK_STREAM, 0);
+  if (socket < 0 ||
+      ::connect(socket, reinterpret_cast<sockaddr*>(&address),
+                sizeof(address)) != 0) {
+    error = std::string("cannot connect to ") + socketPath + ": " +
+            std::strerror(errno);
+    if (socket >= 0) {
+      close(socket);
+      socket = -1;
+    }
+    return false;
+  }
+  return true;
+}
+
+/** send one request line and wait for its answer
+    @return  false if the connection failed */
+bool QueryClient::query(const std::string& request, std::string& answer) {
+  return sendAll(socket, request + "\n") && readLine(answer);
+}
+
+/** send every request at once, then read the answers in order,
+    so the server can batch them
+    @return  false if the connection failed */
+bool QueryClient::queryAll(const std::vector<std::string>& requests,
+                           std::vector<std::string>& answers) {
+  answers.clear();
+  std::string pending;
+  for (const std::string& request : requests) {
+    pending += request;
+    pending += '\n';
+  }
+  // read while still sending, or both sides could block on full buffers
+  size_t sent = 0;
+  char chunk[4096];
+  while (answers.size() < requests.size()) {
+    size_t newline = buffered.find('\n');
+    if (newline != std::string::npos) {
+      answers.push_back(buffered.substr(0, newline));
+      buffered.erase(0, newline + 1);
+      continue;
+    }
+    pollfd entry = pollfd();
+    entry.fd = socket;
+    entry.events = POLLIN | (sent < pending.size() ? POLLOUT : 0);
+    if (poll(&entry, 1, -1) < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return false;
+    }
+    if (entry.revents & POLLOUT) {
+      ssize_t count = ::send(socket, pending.data() + sent,
+                             pending.size() - sent,
+                             MSG_NOSIGNAL | MSG_DONTWAIT);
+      if (count < 0 && errno != EAGAIN && errno != EINTR) {
+        return false;
+      }
+      sent += std::max<ssize_t>(count, 0);
+    }
+    if (entry.revents & (POLLIN | POLLHUP | POLLERR)) {
+      ssize_t count = recv(socket, chunk, sizeof(chunk), MSG_DONTWAIT);
+      if (count == 0 || (count < 0 && errno != EAGAIN && errno != EINTR)) {
+        return false;
+      }
+      buffered.append(chunk, std::max<ssize_t>(count, 0));
+    }
+  }
+  return true;
+}
+
+/** send every request without reading any answer, read them later
+    with receive; the server stops reading from a client that has
+    a lot of answers waiting, so send in moderate amounts
+    @return  false if the connection failed */
+bool QueryClient::send(const std::vector<std::string>& requests) {
+  std::string lines;
+  for (const std::string& request : requests) {
+    lines += request;
+    lines += '\n';
+  }
+  return sendAll(socket, lines);
+}
+
+/** shut down the sending end, the server still answers every
+    request sent and then closes the connection
+    @return  false if the connection failed */
+bool QueryClient::finishSending() {
+  return shutdown(socket, SHUT_WR) == 0;
+}
+
+/** read count answers into answers, in the order of the requests
+    @return  false if the connection failed */
+bool QueryClient::receive(size_t count, std::vector<std::string>& answers) {
+  answers.clear();
+  std::string line;
+  while (answers.size() < count) {
+    if (!readLine(line)) {
+      return false;
+    }
+    answers.push_back(line);
+  }
+  return true;
+}
+
+bool QueryClient::readLine(std::string& line) {
+  char chunk[4096];
+  size_t newline;
+  while ((newline = buffered.find('\n')) == std::string::npos) {
+    ssize_t count = recv(socket, chunk, sizeof(chunk), 0);
+    if (count < 0 && errno == EINTR) {
+      continue;
+    }
+    if (count <= 0) {
+      return false;
+    }
+    buffered.append(chunk, count);
+  }
+  line = buffered.substr(0, newline);
+  buffered.erase(0, newline + 1);
+  return true;
+}
+
+#endif  // _WIN32
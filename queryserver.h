@@ -0,0 +1,253 @@
+/**
+ * Graph query daemon over a Unix domain socket
+ * The graph is loaded once and snapshotted into one IndexedGraph, which
+ * an EdgeIndex and a PathCache share, and then serves any number of local
+ * clients. The Graph itself can be freed once the server is built.
+ *
+ * The protocol is one request per line, one answer line per request, in
+ * the order the requests were sent on that connection:
+ *   BFS <label>            OK <labels in visit order>
+ *   DFS <label>            OK <labels in visit order>
+ *   WEIGHT <from> <to>     OK <cost>            or NONE
+ *   PATH <from> <to>       OK <cost> <labels>   or NONE
+ *   STATS                  OK requests=... p99_us=...
+ * Anything else is answered with ERR, and BUSY when the queue is full.
+ *
+ * One thread polls the sockets and queues complete lines. Workers take up
+ * to maxBatch queued requests at a time, so under load requests from many
+ * clients are answered together: the WEIGHT lookups of a batch go through
+ * one prefetching EdgeIndex::getEdgeWeights call and its PATH queries look
+ * up the cache under one lock, then run the Djikstras for the misses
+ * without it, side by side with other workers. When queueCapacity
+ * requests are waiting, new ones get BUSY at once instead of piling up,
+ * so clients see the overload.
+ * Latencies, arrival to answer, go into a log2 histogram.
+ *
+ * Answers are sent without blocking. What a socket does not take at once
+ * waits on its connection until poll says it can take more, so a client
+ * that stops reading holds up nobody but itself; it is dropped when it
+ * takes none of its answers for a few seconds. A client is not read from
+ * while it has many answer bytes waiting or many requests unanswered, so
+ * neither its answers nor the BUSY lines behind a slow request pile up.
+ * A client that shuts down its sending end still gets every answer
+ * before the server closes.
+ *
+ * POSIX only, the declarations are skipped on Windows.
+ */
+
+#ifndef QUERYSERVER_H
+#define QUERYSERVER_H
+
+#ifndef _WIN32
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "edgeindex.h"
+#include "graph.h"
+#include "indexedgraph.h"
+#include "pathcache.h"
+
+/** counts of latencies in power of two buckets of microseconds,
+    bucket b holds [2^b - 1, 2^(b+1) - 1), safe to record from any thread */
+class LatencyHistogram {
+ public:
+    static const int kBuckets = 40;
+
+    LatencyHistogram();
+
+    /** count one latency */
+    void record(int64_t micros);
+
+    /** return number of latencies recorded */
+    uint64_t getCount() const;
+
+    /** return the upper end of the bucket holding the fraction-th
+        latency, e.g. percentile(0.99), 0 if nothing was recorded */
+    int64_t percentile(double fraction) const;
+
+ private:
+    std::atomic<uint64_t> buckets[kBuckets];
+};
+
+/** how the server listens and how hard it works */
+struct ServerOptions {
+  /** path of the socket file, an old file there is replaced */
+  std::string socketPath;
+
+  /** worker threads, 0 picks one per core */
+  int workers {0};
+
+  /** requests waiting for a worker before new ones get BUSY */
+  size_t queueCapacity {1024};
+
+  /** most requests a worker answers in one batch */
+  size_t maxBatch {64};
+
+  /** memory budget of the shortest-path tree cache */
+  size_t cacheBytes {size_t(64) << 20};
+};
+
+/** what the server has done since start */
+struct ServerStats {
+  /** request lines received, including rejected ones */
+  uint64_t requests {0};
+
+  /** batches the workers ran */
+  uint64_t batches {0};
+
+  /** requests answered BUSY */
+  uint64_t rejected {0};
+
+  /** clients that connected */
+  uint64_t connections {0};
+
+  /** latency percentiles, arrival to answer written */
+  int64_t p50Micros {0};
+  int64_t p90Micros {0};
+  int64_t p99Micros {0};
+};
+
+class QueryServer {
+ public:
+    /** snapshot graph, which is not used after the constructor */
+    QueryServer(const Graph& graph, const ServerOptions& options);
+
+    /** stops the server if it is running */
+    ~QueryServer();
+
+    /** create the socket and start the threads
+        @return  false, with the reason in error, if the socket failed */
+    bool start(std::string& error);
+
+    /** answer what is queued, stop every thread, remove the socket */
+    void stop();
+
+    /** answer request lines without a socket, the way a worker does */
+    std::vector<std::string> handleBatch(
+        const std::vector<std::string>& requests);
+
+    /** counters and latency percentiles so far */
+    ServerStats getStats() const;
+
+ private:
+    struct Connection;
+    struct Request;
+
+    ServerOptions options;
+
+    /** the only copy of the graph, shared with paths */
+    std::shared_ptr<const IndexedGraph> snapshot;
+    EdgeIndex edges;
+
+    /** PathCache is not thread safe, held for lookups and inserts only,
+        never while a tree is computed */
+    std::mutex pathLock;
+    PathCache paths;
+
+    int listener {-1};
+
+    /** written to wake the poll loop, both ends non-blocking */
+    int wake[2] {-1, -1};
+
+    /** set by stop once the workers are done, the poll loop then only
+        writes what is left and returns */
+    std::atomic<bool> closing {false};
+
+    bool started {false};
+    std::thread poller;
+    std::vector<std::thread> workers;
+
+    std::mutex queueLock;
+    std::condition_variable ready;
+    std::deque<Request> queue;
+    bool stopping {false};
+
+    std::atomic<uint64_t> requests {0};
+    std::atomic<uint64_t> batches {0};
+    std::atomic<uint64_t> rejected {0};
+    std::atomic<uint64_t> connections {0};
+    LatencyHistogram latency;
+
+    /** poll loop: accept clients, read lines, queue requests, write the
+        answers sockets did not take at once */
+    void serve();
+
+    /** worker loop: take a batch, answer it */
+    void work();
+
+    /** queue a request, or answer BUSY when the queue is full or the
+        server is stopping */
+    void submit(Request&& request);
+
+    /** send the answer once every earlier answer on its connection
+        has been sent, without blocking, and record its latency */
+    void reply(const Request& request, const std::string& answer);
+
+    /** make the poll loop look at its connections again */
+    void wakePoller();
+
+    /** "OK " and the labels in visit order, NONE if no such vertex */
+    std::string traverse(const std::string& start, bool breadthFirst) const;
+
+    std::string statsLine() const;
+};
+
+/** a blocking client for QueryServer */
+class QueryClient {
+ public:
+    QueryClient();
+
+    /** closes the connection */
+    ~QueryClient();
+
+    /** connect to the server listening on socketPath
+        @return  false, with the reason in error, if it failed */
+    bool connect(const std::string& socketPath, std::string& error);
+
+    /** send one request line and wait for its answer
+        @return  false if the connection failed */
+    bool query(const std::string& request, std::string& answer);
+
+    /** send every request at once, then read the answers in order,
+        so the server can batch them
+        @return  false if the connection failed */
+    bool queryAll(const std::vector<std::string>& requests,
+                  std::vector<std::string>& answers);
+
+    /** send every request without reading any answer, read them later
+        with receive; the server stops reading from a client that has
+        a lot of answers waiting, so send in moderate amounts
+        @return  false if the connection failed */
+    bool send(const std::vector<std::string>& requests);
+
+    /** shut down the sending end, the server still answers every
+        request sent and then closes the connection
+        @return  false if the connection failed */
+    bool finishSending();
+
+    /** read count answers into answers, in the order of the requests
+        @return  false if the connection failed */
+    bool receive(size_t count, std::vector<std::string>& answers);
+
+ private:
+    int socket {-1};
+
+    /** bytes after the last complete answer line */
+    std::string buffered;
+
+    bool readLine(std::string& line);
+};
+
+#endif  // _WIN32
+
+#endif  // QUERYSERVER_H
@@ -0,0 +1,717 @@
+#include "shardedgraph.h"
+
+#ifndef _WIN32
+
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////
+// This is 80 characters - Keep all lines under 80 characters                 //
+////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+/** what the coordinator asks a worker to do, first field of a message */
+enum class Command : uint32_t {
+  Load,           // take a shard: global ids, then start / to / cost
+  BreadthFirst,   // reset, then fewer hops for vertices of the shard
+  Levels,         // send back the level of every vertex of the shard
+  ShortestPath,   // reset, target, bound, then cheaper costs of vertices
+  Trace,          // send back the path into a vertex, up to another shard
+  Quit
+};
+
+/** append the bytes of value, native endian as both ends are one host */
+template <typename T>
+void put(std::string& bytes, const T& value) {
+  bytes.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+/** append a count then the values */
+template <typename T>
+void putArray(std::string& bytes, const std::vector<T>& values) {
+  put<uint64_t>(bytes, values.size());
+  bytes.append(reinterpret_cast<const char*>(values.data()),
+               values.size() * sizeof(T));
+}
+
+/** reads what put and putArray wrote, ok() turns false instead of
+    reading past the end */
+class Cursor {
+ public:
+    explicit Cursor(const std::string& bytes) : bytes(bytes) {}
+
+    template <typename T>
+    T get() {
+      T value = T();
+      if (at + sizeof(T) > bytes.size()) {
+        good = false;
+        return value;
+      }
+      std::memcpy(&value, bytes.data() + at, sizeof(T));
+      at += sizeof(T);
+      return value;
+    }
+
+    template <typename T>
+    void getArray(std::vector<T>& values) {
+      uint64_t count = get<uint64_t>();
+      if (!good || count > (bytes.size() - at) / sizeof(T)) {
+        good = false;
+        values.clear();
+        return;
+      }
+      values.resize(count);
+      if (count > 0) {
+        std::memcpy(values.data(), bytes.data() + at, count * sizeof(T));
+      }
+      at += count * sizeof(T);
+    }
+
+    bool ok() const { return good; }
+
+ private:
+    const std::string& bytes;
+    size_t at {0};
+    bool good {true};
+};
+
+/** send a length, then the message, false if the other end is gone */
+bool sendMessage(int socket, const std::string& message) {
+  std::string frame;
+  put<uint64_t>(frame, message.size());
+  frame += message;
+  size_t sent = 0;
+  while (sent < frame.size()) {
+    ssize_t count = send(socket, frame.data() + sent, frame.size() - sent,
+                         MSG_NOSIGNAL);
+    if (count < 0 && errno == EINTR) {
+      continue;
+    }
+    if (count <= 0) {
+      return false;
+    }
+    sent += count;
+  }
+  return true;
+}
+
+/** read exactly size bytes into data */
+bool receiveAll(int socket, char* data, size_t size) {
+  size_t got = 0;
+  while (got < size) {
+    ssize_t count = recv(socket, data + got, size - got, 0);
+    if (count < 0 && errno == EINTR) {
+      continue;
+    }
+    if (count <= 0) {
+      return false;
+    }
+    got += count;
+  }
+  return true;
+}
+
+/** read one message sent by sendMessage */
+bool receiveMessage(int socket, std::string& message) {
+  uint64_t size = 0;
+  if (!receiveAll(socket, reinterpret_cast<char*>(&size), sizeof(size))) {
+    return false;
+  }
+  message.resize(size);
+  return receiveAll(socket, &message[0], size);
+}
+
+/** the loop a worker process runs over its one shard
+    a vertex of the shard goes by its local index, anything else by its
+    IndexedGraph id; an edge to another shard stores ~id in to */
+template <typename Cost>
+class ShardWorker {
+ public:
+    /** answer the coordinator until it says Quit or goes away */
+    void run(int socket) {
+      std::string request;
+      std::string answer;
+      while (receiveMessage(socket, request)) {
+        Cursor in(request);
+        Command command = static_cast<Command>(in.get<uint32_t>());
+        answer.clear();
+        switch (command) {
+          case Command::Load: load(in, answer); break;
+          case Command::BreadthFirst: breadthFirst(in, answer); break;
+          case Command::Levels: putArray(answer, level); break;
+          case Command::ShortestPath: shortestPath(in, answer); break;
+          case Command::Trace: trace(in, answer); break;
+          default: return;
+        }
+        if (!in.ok() || !sendMessage(socket, answer)) {
+          return;
+        }
+      }
+    }
+
+ private:
+    const Cost infinity = std::numeric_limits<Cost>::max();
+
+    /** the shard: IndexedGraph id of each vertex, then its out-edges */
+    std::vector<int> global;
+    std::vector<int> start;
+    std::vector<int> to;
+    std::vector<Cost> cost;
+
+    /** breadth-first state, hops from the start or -1 */
+    std::vector<int> level;
+
+    /** the fewest hops already offered to each vertex of another shard,
+        anything more would be thrown away there */
+    std::unordered_map<int, int> offered;
+
+    /** shortest path state, previous holds IndexedGraph ids */
+    std::vector<Cost> distance;
+    std::vector<int> previous;
+
+    void load(Cursor& in, std::string& answer) {
+      in.getArray(global);
+      in.getArray(start);
+      in.getArray(to);
+      in.getArray(cost);
+      level.assign(global.size(), -1);
+      distance.assign(global.size(), infinity);
+      previous.assign(global.size(), -1);
+      put<uint32_t>(answer, static_cast<uint32_t>(global.size()));
+    }
+
+    /** take fewer hops for vertices of this shard, search breadth-first
+        inside the shard from them, answer fewer hops for vertices of
+        other shards; the search is Djikstra with every edge one hop, as
+        the vertices it starts from are at different depths */
+    void breadthFirst(Cursor& in, std::string& answer) {
+      bool reset = in.get<uint8_t>() != 0;
+      std::vector<int> vertices;
+      std::vector<int> hops;
+      in.getArray(vertices);
+      in.getArray(hops);
+      if (reset) {
+        std::fill(level.begin(), level.end(), -1);
+        offered.clear();
+      }
+
+      // (hops, local index) min heap, stale entries are skipped
+      typedef std::pair<int, int> Entry;
+      std::vector<Entry> heap;
+      for (size_t i = 0; i < vertices.size() && i < hops.size(); ++i) {
+        int v = vertices[i];
+        if (level[v] < 0 || hops[i] < level[v]) {
+          level[v] = hops[i];
+          heap.push_back(Entry(hops[i], v));
+        }
+      }
+      std::make_heap(heap.begin(), heap.end(), std::greater<Entry>());
+
+      std::vector<int> offerVertices;
+      std::vector<int> offerHops;
+      while (!heap.empty()) {
+        std::pop_heap(heap.begin(), heap.end(), std::greater<Entry>());
+        Entry top = heap.back();
+        heap.pop_back();
+        int v = top.second;
+        if (level[v] < top.first) {
+          continue;
+        }
+        int through = top.first + 1;
+        for (int e = start[v]; e < start[v + 1]; ++e) {
+          int w = to[e];
+          if (w < 0) {
+            auto known = offered.find(~w);
+            if (known == offered.end() || through < known->second) {
+              offered[~w] = through;
+              offerVertices.push_back(~w);
+              offerHops.push_back(through);
+            }
+          } else if (level[w] < 0 || through < level[w]) {
+            level[w] = through;
+            heap.push_back(Entry(through, w));
+            std::push_heap(heap.begin(), heap.end(), std::greater<Entry>());
+          }
+        }
+      }
+      putArray(answer, offerVertices);
+      putArray(answer, offerHops);
+    }
+
+    /** take cheaper costs for vertices of this shard, run Djikstra from
+        them inside the shard below bound, answer the cost of target if
+        it is here and the cheapest offer for each vertex of another
+        shard */
+    void shortestPath(Cursor& in, std::string& answer) {
+      bool reset = in.get<uint8_t>() != 0;
+      int target = in.get<int32_t>();
+      Cost bound = in.get<Cost>();
+      std::vector<int> vertices;
+      std::vector<Cost> costs;
+      std::vector<int> from;
+      in.getArray(vertices);
+      in.getArray(costs);
+      in.getArray(from);
+      if (reset) {
+        std::fill(distance.begin(), distance.end(), infinity);
+        std::fill(previous.begin(), previous.end(), -1);
+      }
+
+      // (cost so far, local index) min heap, stale entries are skipped
+      typedef std::pair<Cost, int> Entry;
+      std::vector<Entry> heap;
+      for (size_t i = 0; i < vertices.size() && i < costs.size() &&
+                         i < from.size(); ++i) {
+        int v = vertices[i];
+        if (costs[i] < distance[v]) {
+          distance[v] = costs[i];
+          previous[v] = from[i];
+          heap.push_back(Entry(costs[i], v));
+        }
+      }
+      std::make_heap(heap.begin(), heap.end(), std::greater<Entry>());
+
+      // (IndexedGraph id, cost, IndexedGraph id of the vertex before)
+      std::vector<std::tuple<int, Cost, int>> offers;
+      while (!heap.empty()) {
+        std::pop_heap(heap.begin(), heap.end(), std::greater<Entry>());
+        Entry top = heap.back();
+        heap.pop_back();
+        int v = top.second;
+        if (distance[v] < top.first) {
+          continue;
+        }
+        if (top.first >= bound) {
+          break;
+        }
+        if (v == target) {
+          bound = top.first;
+          continue;
+        }
+        for (int e = start[v]; e < start[v + 1]; ++e) {
+          Cost through = top.first + cost[e];
+          int w = to[e];
+          if (through >= bound) {
+            continue;
+          }
+          if (w < 0) {
+            offers.emplace_back(~w, through, global[v]);
+          } else if (through < distance[w]) {
+            distance[w] = through;
+            previous[w] = global[v];
+            heap.push_back(Entry(through, w));
+            std::push_heap(heap.begin(), heap.end(), std::greater<Entry>());
+          }
+        }
+      }
+
+      // keep the cheapest offer for each vertex
+      std::sort(offers.begin(), offers.end());
+      std::vector<int> offerVertices;
+      std::vector<Cost> offerCosts;
+      std::vector<int> offerFrom;
+      for (size_t i = 0; i < offers.size(); ++i) {
+        if (i == 0 || std::get<0>(offers[i]) != std::get<0>(offers[i - 1])) {
+          offerVertices.push_back(std::get<0>(offers[i]));
+          offerCosts.push_back(std::get<1>(offers[i]));
+          offerFrom.push_back(std::get<2>(offers[i]));
+        }
+      }
+      put<Cost>(answer, target >= 0 ? distance[target] : infinity);
+      putArray(answer, offerVertices);
+      putArray(answer, offerCosts);
+      putArray(answer, offerFrom);
+    }
+
+    /** answer the IndexedGraph ids on the path into a vertex, walking
+        back while the vertex before is in this shard, then the id of
+        the vertex before the last, -1 at the source */
+    void trace(Cursor& in, std::string& answer) {
+      int v = in.get<int32_t>();
+      std::vector<int> chain;
+      int before = -1;
+      for (size_t steps = 0; steps < global.size(); ++steps) {
+        chain.push_back(global[v]);
+        before = previous[v];
+        if (before < 0) {
+          break;
+        }
+        auto found = std::lower_bound(global.begin(), global.end(), before);
+        if (found == global.end() || *found != before) {
+          break;
+        }
+        v = static_cast<int>(found - global.begin());
+        before = -1;
+      }
+      putArray(answer, chain);
+      put<int32_t>(answer, before);
+    }
+};
+
+}  // namespace
+
+/** shard graph along partition, one shard per part
+    graph and partition must outlive this object */
+template <typename Label, typename Weight>
+BasicShardedGraph<Label, Weight>::BasicShardedGraph(
+    const BasicIndexedGraph<Label, Weight>& graph,
+    const BasicPartition<Label, Weight>& partition)
+    : graph(graph), partition(partition) {
+  const std::vector<int>& part = partition.getParts();
+  members.resize(partition.getNumParts());
+  localId.resize(part.size());
+  for (size_t v = 0; v < part.size(); ++v) {
+    localId[v] = static_cast<int>(members[part[v]].size());
+    members[part[v]].push_back(static_cast<int>(v));
+  }
+}
+
+/** stop the workers */
+template <typename Label, typename Weight>
+BasicShardedGraph<Label, Weight>::~BasicShardedGraph() {
+  stop();
+}
+
+/** fork the workers and load their shards
+    @return  false with a reason in error if that failed */
+template <typename Label, typename Weight>
+bool BasicShardedGraph<Label, Weight>::start(std::string& error) {
+  if (!sockets.empty()) {
+    return true;
+  }
+  int shards = getNumShards();
+  for (int q = 0; q < shards; ++q) {
+    int pair[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, pair) != 0) {
+      error = std::string("socketpair: ") + std::strerror(errno);
+      stop();
+      return false;
+    }
+    pid_t pid = fork();
+    if (pid < 0) {
+      error = std::string("fork: ") + std::strerror(errno);
+      close(pair[0]);
+      close(pair[1]);
+      stop();
+      return false;
+    }
+    if (pid == 0) {
+      close(pair[0]);
+      for (int socket : sockets) {
+        close(socket);
+      }
+      ShardWorker<Cost> worker;
+      worker.run(pair[1]);
+      _exit(0);
+    }
+    close(pair[1]);
+    sockets.push_back(pair[0]);
+    workers.push_back(pid);
+  }
+
+  // each shard's edges, the ones leaving the shard as ~IndexedGraph id
+  const std::vector<int>& part = partition.getParts();
+  std::vector<std::string> requests(shards);
+  std::vector<int> neighbors;
+  std::vector<Cost> costs;
+  for (int q = 0; q < shards; ++q) {
+    std::vector<int> start(1, 0);
+    neighbors.clear();
+    costs.clear();
+    for (int v : members[q]) {
+      graph.getNeighbors(v, neighbors, &costs);
+      start.push_back(static_cast<int>(neighbors.size()));
+    }
+    for (int& w : neighbors) {
+      w = part[w] == q ? localId[w] : ~w;
+    }
+    put<uint32_t>(requests[q], static_cast<uint32_t>(Command::Load));
+    putArray(requests[q], members[q]);
+    putArray(requests[q], start);
+    putArray(requests[q], neighbors);
+    putArray(requests[q], costs);
+  }
+  std::vector<std::string> answers;
+  broken = false;
+  if (!exchange(requests, answers)) {
+    error = "a worker failed while loading its shard";
+    stop();
+    return false;
+  }
+  return true;
+}
+
+/** tell the workers to exit and wait for them, safe to call twice */
+template <typename Label, typename Weight>
+void BasicShardedGraph<Label, Weight>::stop() {
+  std::string quit;
+  put<uint32_t>(quit, static_cast<uint32_t>(Command::Quit));
+  for (int socket : sockets) {
+    sendMessage(socket, quit);
+    close(socket);
+  }
+  for (pid_t pid : workers) {
+    while (waitpid(pid, nullptr, 0) < 0 && errno == EINTR) {
+    }
+  }
+  sockets.clear();
+  workers.clear();
+}
+
+/** return number of shards */
+template <typename Label, typename Weight>
+int BasicShardedGraph<Label, Weight>::getNumShards() const {
+  return partition.getNumParts();
+}
+
+/** level[id] = hops from start to IndexedGraph id, -1 if unreached
+    @return  number of vertices reached, 0 if there is no start */
+template <typename Label, typename Weight>
+int BasicShardedGraph<Label, Weight>::breadthFirstSearch(
+    const Label& start, std::vector<int>& level) {
+  const std::vector<int>& part = partition.getParts();
+  int shards = getNumShards();
+  stats = ShardStats();
+  level.assign(graph.getNumVertices(), -1);
+  int from = graph.getId(start);
+  if (from < 0 || sockets.empty() || broken) {
+    return 0;
+  }
+
+  // fewer hops waiting for each shard: local index, hops
+  std::vector<std::vector<int>> vertices(shards);
+  std::vector<std::vector<int>> hops(shards);
+  vertices[part[from]].push_back(localId[from]);
+  hops[part[from]].push_back(0);
+  std::vector<std::string> requests(shards);
+  std::vector<std::string> answers;
+  std::vector<int> offerVertices;
+  std::vector<int> offerHops;
+  for (bool first = true;; first = false) {
+    for (int q = 0; q < shards; ++q) {
+      requests[q].clear();
+      put<uint32_t>(requests[q],
+                    static_cast<uint32_t>(Command::BreadthFirst));
+      put<uint8_t>(requests[q], first ? 1 : 0);
+      putArray(requests[q], vertices[q]);
+      putArray(requests[q], hops[q]);
+      vertices[q].clear();
+      hops[q].clear();
+    }
+    if (!exchange(requests, answers)) {
+      return 0;
+    }
+
+    bool active = false;
+    for (int q = 0; q < shards; ++q) {
+      Cursor in(answers[q]);
+      in.getArray(offerVertices);
+      in.getArray(offerHops);
+      for (size_t i = 0; i < offerVertices.size() && i < offerHops.size();
+           ++i) {
+        int w = offerVertices[i];
+        vertices[part[w]].push_back(localId[w]);
+        hops[part[w]].push_back(offerHops[i]);
+      }
+      stats.messages += offerVertices.size();
+      active = active || !offerVertices.empty();
+    }
+    if (!active) {
+      break;
+    }
+  }
+
+  // gather the levels, each shard's in local order
+  for (int q = 0; q < shards; ++q) {
+    requests[q].clear();
+    put<uint32_t>(requests[q], static_cast<uint32_t>(Command::Levels));
+  }
+  if (!exchange(requests, answers)) {
+    return 0;
+  }
+  int reached = 0;
+  std::vector<int> shardLevel;
+  for (int q = 0; q < shards; ++q) {
+    Cursor in(answers[q]);
+    in.getArray(shardLevel);
+    for (size_t i = 0; i < shardLevel.size() && i < members[q].size();
+         ++i) {
+      level[members[q][i]] = shardLevel[i];
+      reached += shardLevel[i] >= 0 ? 1 : 0;
+    }
+  }
+  return reached;
+}
+
+/** return the cost of the cheapest path from source to target,
+    WeightTraits<Weight>::infinity() if there is none, with its
+    labels, source first, in path */
+template <typename Label, typename Weight>
+typename BasicShardedGraph<Label, Weight>::Cost
+BasicShardedGraph<Label, Weight>::shortestPath(const Label& source,
+                                               const Label& target,
+                                               std::vector<Label>& path) {
+  const Cost infinity = WeightTraits<Weight>::infinity();
+  const std::vector<int>& part = partition.getParts();
+  int shards = getNumShards();
+  stats = ShardStats();
+  path.clear();
+  int from = graph.getId(source);
+  int goal = graph.getId(target);
+  if (from < 0 || goal < 0 || sockets.empty() || broken) {
+    return infinity;
+  }
+
+  // cheaper costs waiting for each shard: local index, cost, vertex before
+  std::vector<std::vector<int>> vertices(shards);
+  std::vector<std::vector<Cost>> costs(shards);
+  std::vector<std::vector<int>> befores(shards);
+  vertices[part[from]].push_back(localId[from]);
+  costs[part[from]].push_back(Cost());
+  befores[part[from]].push_back(-1);
+
+  Cost bound = infinity;
+  std::vector<std::string> requests(shards);
+  std::vector<std::string> answers;
+  std::vector<std::vector<int>> offerVertices(shards);
+  std::vector<std::vector<Cost>> offerCosts(shards);
+  std::vector<std::vector<int>> offerFrom(shards);
+  for (bool first = true;; first = false) {
+    for (int q = 0; q < shards; ++q) {
+      requests[q].clear();
+      put<uint32_t>(requests[q],
+                    static_cast<uint32_t>(Command::ShortestPath));
+      put<uint8_t>(requests[q], first ? 1 : 0);
+      put<int32_t>(requests[q], part[goal] == q ? localId[goal] : -1);
+      put<Cost>(requests[q], bound);
+      putArray(requests[q], vertices[q]);
+      putArray(requests[q], costs[q]);
+      putArray(requests[q], befores[q]);
+      vertices[q].clear();
+      costs[q].clear();
+      befores[q].clear();
+    }
+    if (!exchange(requests, answers)) {
+      return infinity;
+    }
+
+    // the bound from this superstep prunes the offers made in it
+    for (int q = 0; q < shards; ++q) {
+      Cursor in(answers[q]);
+      bound = std::min(bound, in.get<Cost>());
+      in.getArray(offerVertices[q]);
+      in.getArray(offerCosts[q]);
+      in.getArray(offerFrom[q]);
+    }
+    bool active = false;
+    for (int q = 0; q < shards; ++q) {
+      size_t count = std::min(offerVertices[q].size(),
+                              std::min(offerCosts[q].size(),
+                                       offerFrom[q].size()));
+      for (size_t i = 0; i < count; ++i) {
+        if (offerCosts[q][i] >= bound) {
+          continue;
+        }
+        int w = offerVertices[q][i];
+        vertices[part[w]].push_back(localId[w]);
+        costs[part[w]].push_back(offerCosts[q][i]);
+        befores[part[w]].push_back(offerFrom[q][i]);
+        stats.messages++;
+        active = true;
+      }
+    }
+    if (!active) {
+      break;
+    }
+  }
+  if (bound == infinity) {
+    return infinity;
+  }
+
+  // walk back from the target, one request per shard crossing
+  std::vector<int> ids;
+  std::vector<int> chain;
+  for (int v = goal; v >= 0 && ids.size() < part.size();) {
+    for (int q = 0; q < shards; ++q) {
+      requests[q].clear();
+    }
+    put<uint32_t>(requests[part[v]], static_cast<uint32_t>(Command::Trace));
+    put<int32_t>(requests[part[v]], localId[v]);
+    if (!exchange(requests, answers)) {
+      return infinity;
+    }
+    Cursor in(answers[part[v]]);
+    in.getArray(chain);
+    ids.insert(ids.end(), chain.begin(), chain.end());
+    v = in.get<int32_t>();
+  }
+  for (auto id = ids.rbegin(); id != ids.rend(); ++id) {
+    path.push_back(graph.getLabel(*id));
+  }
+  return bound;
+}
+
+/** traffic of the last query */
+template <typename Label, typename Weight>
+const ShardStats& BasicShardedGraph<Label, Weight>::getStats() const {
+  return stats;
+}
+
+/** return true once a worker has died or the socket to it failed,
+    every query after that returns nothing */
+template <typename Label, typename Weight>
+bool BasicShardedGraph<Label, Weight>::failed() const {
+  return broken;
+}
+
+/** send every shard its message and read back every answer,
+    false if any worker failed; an empty request skips that shard
+    every request is written before any answer is read, a worker reads
+    all of its request before answering, so neither end waits on the
+    other while holding a full socket buffer */
+template <typename Label, typename Weight>
+bool BasicShardedGraph<Label, Weight>::exchange(
+    const std::vector<std::string>& requests,
+    std::vector<std::string>& answers) {
+  answers.resize(requests.size());
+  for (size_t q = 0; q < requests.size() && !broken; ++q) {
+    if (!requests[q].empty()) {
+      broken = !sendMessage(sockets[q], requests[q]);
+      stats.bytes += requests[q].size() + sizeof(uint64_t);
+    }
+  }
+  for (size_t q = 0; q < requests.size() && !broken; ++q) {
+    answers[q].clear();
+    if (!requests[q].empty()) {
+      broken = !receiveMessage(sockets[q], answers[q]);
+      stats.bytes += answers[q].size() + sizeof(uint64_t);
+    }
+  }
+  stats.supersteps++;
+  return !broken;
+}
+
+// same label and weight types as BasicGraph
+template class BasicShardedGraph<std::string, int>;
+template class BasicShardedGraph<std::string, long long>;
+template class BasicShardedGraph<std::string, double>;
+template class BasicShardedGraph<std::string, Unweighted>;
+template class BasicShardedGraph<int, int>;
+template class BasicShardedGraph<int, long long>;
+template class BasicShardedGraph<int, double>;
+template class BasicShardedGraph<int, Unweighted>;
+
+#endif  // _WIN32
@@ -0,0 +1,126 @@
+/**
+ * Queries over an IndexedGraph split into shards, one worker process each
+ * start() forks a worker per part of a Partition, connected to this
+ * process, the coordinator, by a socketpair, and sends it its shard: the
+ * vertices of the part and their out-edges, nothing else. Workers never
+ * touch the graph they were forked with, so the same worker loop would
+ * serve a shard on another host over TCP.
+ *
+ * Queries run in supersteps. The coordinator sends every worker the
+ * messages addressed to its vertices, each worker does all the work it can
+ * inside its shard, and answers with the messages for vertices of other
+ * shards, which the coordinator routes for the next superstep. A message
+ * is a lower hop count (breadthFirstSearch) or cost (shortestPath) for a
+ * vertex, and a worker searches its shard from the vertices that got one.
+ * A superstep covers as many levels as the shard holds, so the number of
+ * supersteps follows how often paths cross shards, not how deep they go,
+ * at the price of redoing a vertex when a shorter way in turns up later.
+ * shortestPath expands nothing at or above the best cost to the target
+ * found so far. Only cut edges produce messages, which is what the
+ * partition minimizes. The path is read back one shard crossing at a time.
+ *
+ * POSIX only, the declarations are skipped on Windows. Call start() before
+ * starting other threads, the workers are forked.
+ */
+
+#ifndef SHARDEDGRAPH_H
+#define SHARDEDGRAPH_H
+
+#ifndef _WIN32
+
+#include <sys/types.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "indexedgraph.h"
+#include "partition.h"
+
+/** what the last query cost in supersteps and traffic */
+struct ShardStats {
+  /** rounds of messages between the coordinator and the workers */
+  uint64_t supersteps {0};
+
+  /** vertex messages routed from one shard to another */
+  uint64_t messages {0};
+
+  /** bytes written to and read from the workers */
+  uint64_t bytes {0};
+};
+
+template <typename Label, typename Weight>
+class BasicShardedGraph {
+ public:
+    typedef typename WeightTraits<Weight>::Cost Cost;
+
+    /** shard graph along partition, one shard per part
+        graph and partition must outlive this object */
+    BasicShardedGraph(const BasicIndexedGraph<Label, Weight>& graph,
+                      const BasicPartition<Label, Weight>& partition);
+
+    /** stop the workers */
+    ~BasicShardedGraph();
+
+    BasicShardedGraph(const BasicShardedGraph&) = delete;
+    BasicShardedGraph& operator=(const BasicShardedGraph&) = delete;
+
+    /** fork the workers and load their shards
+        @return  false with a reason in error if that failed */
+    bool start(std::string& error);
+
+    /** tell the workers to exit and wait for them, safe to call twice */
+    void stop();
+
+    /** return number of shards */
+    int getNumShards() const;
+
+    /** level[id] = hops from start to IndexedGraph id, -1 if unreached
+        @return  number of vertices reached, 0 if there is no start */
+    int breadthFirstSearch(const Label& start, std::vector<int>& level);
+
+    /** return the cost of the cheapest path from source to target,
+        WeightTraits<Weight>::infinity() if there is none, with its
+        labels, source first, in path */
+    Cost shortestPath(const Label& source, const Label& target,
+                      std::vector<Label>& path);
+
+    /** traffic of the last query */
+    const ShardStats& getStats() const;
+
+    /** return true once a worker has died or the socket to it failed,
+        every query after that returns nothing */
+    bool failed() const;
+
+ private:
+    const BasicIndexedGraph<Label, Weight>& graph;
+    const BasicPartition<Label, Weight>& partition;
+
+    /** the index of every vertex in the vertex list of its shard */
+    std::vector<int> localId;
+
+    /** the vertices of each shard, IndexedGraph ids by local index */
+    std::vector<std::vector<int>> members;
+
+    /** coordinator end of each worker's socketpair, and its pid */
+    std::vector<int> sockets;
+    std::vector<pid_t> workers;
+
+    ShardStats stats;
+    bool broken {false};
+
+    /** send every shard its message and read back every answer,
+        false if any worker failed; an empty request skips that shard
+        every request is written before any answer is read, a worker reads
+        all of its request before answering, so neither end waits on the
+        other while holding a full socket buffer */
+    bool exchange(const std::vector<std::string>& requests,
+                  std::vector<std::string>& answers);
+};
+
+/** sharded snapshot of the assignment's Graph */
+typedef BasicShardedGraph<std::string, int> ShardedGraph;
+
+#endif  // _WIN32
+
+#endif  // SHARDEDGRAPH_H
@@ -0,0 +1,172 @@
+#include "spanningforest.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "unionfind.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// This is 80 characters - Keep all lines under 80 characters                 //
+////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+/** run work(t, begin, end) on threads slices of [0, count),
+    slice 0 on the calling thread */
+template <typename Work>
+void inSlices(int threads, int count, const Work& work) {
+  int slice = (count + threads - 1) / threads;
+  std::vector<std::thread> workers;
+  for (int t = 1; t < threads; ++t) {
+    workers.emplace_back(work, t, std::min(count, t * slice),
+                         std::min(count, (t + 1) * slice));
+  }
+  work(0, 0, std::min(count, slice));
+  for (std::thread& worker : workers) {
+    worker.join();
+  }
+}
+
+}  // namespace
+
+/** find the forest
+    threads is the number of Boruvka workers, 0 picks one per core */
+template <typename Label, typename Weight>
+BasicSpanningForest<Label, Weight>::BasicSpanningForest(
+    const BasicIndexedGraph<Label, Weight>& graph, int threads) {
+  int n = graph.getNumVertices();
+  if (threads <= 0) {
+    threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  threads = std::max(1, threads);
+
+  // every edge as (from, to, cost), its index is its tie breaker
+  std::vector<int> from;
+  std::vector<int> to;
+  std::vector<Cost> cost;
+  std::vector<int> neighbors;
+  std::vector<Cost> neighborCosts;
+  for (int v = 0; v < n; ++v) {
+    neighbors.clear();
+    neighborCosts.clear();
+    graph.getNeighbors(v, neighbors, &neighborCosts);
+    for (size_t i = 0; i < neighbors.size(); ++i) {
+      if (neighbors[i] != v) {
+        from.push_back(v);
+        to.push_back(neighbors[i]);
+        cost.push_back(neighborCosts[i]);
+      }
+    }
+  }
+  auto lighter = [&cost](int e, int f) {
+    return cost[e] < cost[f] || (!(cost[f] < cost[e]) && e < f);
+  };
+
+  ConcurrentUnionFind sets(n);
+  std::unique_ptr<std::atomic<int>[]> lightest(new std::atomic<int>[n]);
+  for (int v = 0; v < n; ++v) {
+    lightest[v].store(-1, std::memory_order_relaxed);
+  }
+  std::vector<char> chosen(cost.size(), 0);
+  std::vector<int> live(cost.size());
+  for (size_t e = 0; e < live.size(); ++e) {
+    live[e] = static_cast<int>(e);
+  }
+  std::vector<std::vector<int>> kept(threads);
+  std::vector<int> merged(threads);
+
+  while (!live.empty()) {
+    // offer every edge between two components to both of them
+    inSlices(threads, static_cast<int>(live.size()),
+             [&](int t, int begin, int end) {
+      kept[t].clear();
+      for (int i = begin; i < end; ++i) {
+        int e = live[i];
+        int a = sets.find(from[e]);
+        int b = sets.find(to[e]);
+        if (a == b) {
+          continue;
+        }
+        kept[t].push_back(e);
+        for (int root : {a, b}) {
+          int current = lightest[root].load(std::memory_order_relaxed);
+          while ((current < 0 || lighter(e, current)) &&
+                 !lightest[root].compare_exchange_weak(current, e)) {
+          }
+        }
+      }
+    });
+    live.clear();
+    for (const std::vector<int>& slice : kept) {
+      live.insert(live.end(), slice.begin(), slice.end());
+    }
+
+    // merge along each component's lightest edge, an edge picked by both
+    // of its components only merges once
+    inSlices(threads, n, [&](int t, int begin, int end) {
+      merged[t] = 0;
+      for (int v = begin; v < end; ++v) {
+        int e = lightest[v].exchange(-1, std::memory_order_relaxed);
+        if (e >= 0 && sets.unite(from[e], to[e])) {
+          chosen[e] = 1;
+          ++merged[t];
+        }
+      }
+    });
+    int merges = 0;
+    for (int count : merged) {
+      merges += count;
+    }
+    if (merges == 0) {
+      break;
+    }
+  }
+
+  std::vector<int> picked;
+  for (size_t e = 0; e < chosen.size(); ++e) {
+    if (chosen[e]) {
+      picked.push_back(static_cast<int>(e));
+    }
+  }
+  std::sort(picked.begin(), picked.end(), lighter);
+  for (int e : picked) {
+    edges.push_back(
+        TreeEdge {graph.getLabel(from[e]), graph.getLabel(to[e]), cost[e]});
+    totalWeight += cost[e];
+  }
+  trees = n - static_cast<int>(edges.size());
+}
+
+/** return the sum of the costs of the forest's edges */
+template <typename Label, typename Weight>
+typename BasicSpanningForest<Label, Weight>::Cost
+BasicSpanningForest<Label, Weight>::getTotalWeight() const {
+  return totalWeight;
+}
+
+/** return number of trees, one per weakly connected component */
+template <typename Label, typename Weight>
+int BasicSpanningForest<Label, Weight>::getNumTrees() const {
+  return trees;
+}
+
+/** the forest's edges, lightest first */
+template <typename Label, typename Weight>
+const std::vector<typename BasicSpanningForest<Label, Weight>::TreeEdge>&
+BasicSpanningForest<Label, Weight>::getEdges() const {
+  return edges;
+}
+
+// same label and weight types as BasicGraph
+template class BasicSpanningForest<std::string, int>;
+template class BasicSpanningForest<std::string, long long>;
+template class BasicSpanningForest<std::string, double>;
+template class BasicSpanningForest<std::string, Unweighted>;
+template class BasicSpanningForest<int, int>;
+template class BasicSpanningForest<int, long long>;
+template class BasicSpanningForest<int, double>;
+template class BasicSpanningForest<int, Unweighted>;
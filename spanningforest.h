@@ -0,0 +1,57 @@
+/**
+ * Minimum spanning forest of an IndexedGraph, edges taken as undirected
+ * Parallel Boruvka: each round every edge offers itself to the components
+ * at both of its ends, each component keeps the lightest offer through an
+ * atomic compare-and-swap minimum, and the kept edges are merged in a
+ * ConcurrentUnionFind. Edges inside one component are dropped as rounds go,
+ * and the number of components at least halves every round.
+ *
+ * Equal costs are broken by edge order, so every edge has a distinct rank,
+ * the forest is unique and the result does not depend on the threads.
+ * A directed edge in both directions is two candidates for the same link.
+ */
+
+#ifndef SPANNINGFOREST_H
+#define SPANNINGFOREST_H
+
+#include <string>
+#include <vector>
+
+#include "indexedgraph.h"
+
+template <typename Label, typename Weight>
+class BasicSpanningForest {
+ public:
+    typedef typename WeightTraits<Weight>::Cost Cost;
+
+    /** an edge of the forest */
+    struct TreeEdge {
+      Label from;
+      Label to;
+      Cost cost;
+    };
+
+    /** find the forest
+        threads is the number of Boruvka workers, 0 picks one per core */
+    explicit BasicSpanningForest(
+        const BasicIndexedGraph<Label, Weight>& graph, int threads = 0);
+
+    /** return the sum of the costs of the forest's edges */
+    Cost getTotalWeight() const;
+
+    /** return number of trees, one per weakly connected component */
+    int getNumTrees() const;
+
+    /** the forest's edges, lightest first */
+    const std::vector<TreeEdge>& getEdges() const;
+
+ private:
+    Cost totalWeight {};
+    int trees {0};
+    std::vector<TreeEdge> edges;
+};
+
+/** spanning forest of the assignment's Graph */
+typedef BasicSpanningForest<std::string, int> SpanningForest;
+
+#endif  // SPANNINGFOREST_H
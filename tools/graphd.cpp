@@ -0,0 +1,91 @@
+/**
+ * Command line front end for QueryServer
+ * Loads a readFile graph once and answers queries on a Unix socket until
+ * interrupted
+ *
+ * graphd --graph graph1.txt --socket /tmp/graphd.sock --workers 4
+ * printf 'PATH A G\nSTATS\n' | nc -U /tmp/graphd.sock
+ */
+
+#include <signal.h>
+
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include "graph.h"
+#include "queryserver.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// This is 80 characters - Keep all lines under 80 characters                 //
+////////////////////////////////////////////////////////////////////////////////
+
+using namespace std;
+
+void usage() {
+  cerr << "usage: graphd --graph FILE --socket PATH [--workers N]"
+       << "\n              [--queue N] [--batch N] [--cache-mb N]"
+       << "\n--workers 0 (the default) runs one worker per core" << endl;
+}
+
+int main(int argc, char* argv[]) {
+  ServerOptions options;
+  string graphFile;
+
+  for (int i = 1; i + 1 < argc; i += 2) {
+    string flag = argv[i];
+    string value = argv[i + 1];
+    if (flag == "--graph") {
+      graphFile = value;
+    } else if (flag == "--socket") {
+      options.socketPath = value;
+    } else if (flag == "--workers") {
+      options.workers = atoi(value.c_str());
+    } else if (flag == "--queue") {
+      options.queueCapacity = strtoull(value.c_str(), nullptr, 10);
+    } else if (flag == "--batch") {
+      options.maxBatch = strtoull(value.c_str(), nullptr, 10);
+    } else if (flag == "--cache-mb") {
+      options.cacheBytes = strtoull(value.c_str(), nullptr, 10) << 20;
+    } else {
+      usage();
+      return 1;
+    }
+  }
+  if (argc % 2 == 0 || graphFile.empty() || options.socketPath.empty()) {
+    usage();
+    return 1;
+  }
+
+  // block the signals before any thread starts, so only sigwait sees them
+  sigset_t signals;
+  sigemptyset(&signals);
+  sigaddset(&signals, SIGINT);
+  sigaddset(&signals, SIGTERM);
+  pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+  signal(SIGPIPE, SIG_IGN);
+
+  // the server keeps its own snapshot, the Graph goes once it is built
+  unique_ptr<QueryServer> server;
+  {
+    Graph graph;
+    graph.readFile(graphFile);
+    server.reset(new QueryServer(graph, options));
+  }
+  string error;
+  if (!server->start(error)) {
+    cerr << "ERROR: " << error << endl;
+    return 1;
+  }
+  cerr << "serving " << graphFile << " on " << options.socketPath << endl;
+
+  int received = 0;
+  sigwait(&signals, &received);
+  server->stop();
+  ServerStats stats = server->getStats();
+  cerr << stats.requests << " requests in " << stats.batches
+       << " batches, " << stats.rejected << " busy, p50 "
+       << stats.p50Micros << "us p99 " << stats.p99Micros << "us" << endl;
+  return 0;
+}
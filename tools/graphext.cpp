@@ -0,0 +1,127 @@
+/**
+ * Command line front end for ExternalGraph
+ * Sorts a binary edge file from graphgen, then runs breadth-first search
+ * or weak components over it without loading the edges into memory, or
+ * loads it as a compressed IndexedGraph
+ *
+ * graphext sort rmat1b.bin rmat1b.sorted.bin --memory-mb 4096
+ * graphext bfs rmat1b.sorted.bin 0
+ * graphext components rmat1b.sorted.bin
+ * graphext load rmat100m.sorted.bin
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "externalgraph.h"
+#include "indexedgraph.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// This is 80 characters - Keep all lines under 80 characters                 //
+////////////////////////////////////////////////////////////////////////////////
+
+using namespace std;
+
+void usage() {
+  cerr << "usage: graphext sort INPUT OUTPUT [--memory-mb N]"
+       << "\n       graphext bfs SORTED START [--block-mb N]"
+       << "\n       graphext components SORTED [--block-mb N]"
+       << "\n       graphext load SORTED"
+       << "\nINPUT is a binary edge file from graphgen --format binary,"
+       << "\nSORTED the output of graphext sort" << endl;
+}
+
+double secondsSince(chrono::steady_clock::time_point start) {
+  return chrono::duration<double>(chrono::steady_clock::now() - start)
+      .count();
+}
+
+int main(int argc, char* argv[]) {
+  if (argc < 3) {
+    usage();
+    return 1;
+  }
+  string command = argv[1];
+  vector<string> positional;
+  size_t memoryMB = 1024;
+  size_t blockMB = 4;
+  for (int i = 2; i < argc; ++i) {
+    string arg = argv[i];
+    if ((arg == "--memory-mb" || arg == "--block-mb") && i + 1 < argc) {
+      size_t value = strtoull(argv[++i], nullptr, 10);
+      (arg == "--memory-mb" ? memoryMB : blockMB) = value;
+    } else {
+      positional.push_back(arg);
+    }
+  }
+
+  string error;
+  chrono::steady_clock::time_point start = chrono::steady_clock::now();
+  if (command == "sort" && positional.size() == 2) {
+    if (!ExternalGraph::sortEdgeFile(positional[0], positional[1],
+                                     memoryMB << 20, error)) {
+      cerr << "ERROR: " << error << endl;
+      return 1;
+    }
+    cerr << "sorted in " << secondsSince(start) << "s" << endl;
+    return 0;
+  }
+
+  if (command == "load" && positional.size() == 1) {
+    // rows are compressed as they stream in, the edges never sit in RAM
+    IndexedGraphBuilder builder;
+    unique_ptr<IndexedGraph> graph;
+    if (!ExternalGraph::streamEdgeFile(positional[0], builder, error) ||
+        !(graph = builder.finish(error))) {
+      cerr << "ERROR: " << error << endl;
+      return 1;
+    }
+    cout << graph->getNumVertices() << " vertices " << graph->getNumEdges()
+         << " edges, "
+         << static_cast<double>(graph->getAdjacencyBytes()) /
+                max(1, graph->getNumEdges())
+         << " adjacency bytes an edge" << endl;
+    cerr << "loaded in " << secondsSince(start) << "s" << endl;
+    return 0;
+  }
+
+  size_t wanted = command == "bfs" ? 2 : 1;
+  if ((command != "bfs" && command != "components") ||
+      positional.size() != wanted) {
+    usage();
+    return 1;
+  }
+  ExternalGraph graph(blockMB << 20);
+  if (!graph.open(positional[0], error)) {
+    cerr << "ERROR: " << error << endl;
+    return 1;
+  }
+  cerr << graph.getNumVertices() << " vertices " << graph.getNumEdges()
+       << " edges, opened in " << secondsSince(start) << "s" << endl;
+  start = chrono::steady_clock::now();
+
+  if (command == "bfs") {
+    vector<uint32_t> level;
+    uint64_t reached = graph.breadthFirstSearch(
+        static_cast<uint32_t>(strtoul(positional[1].c_str(), nullptr, 10)),
+        level);
+    uint32_t deepest = 0;
+    for (uint32_t l : level) {
+      if (l != ExternalGraph::kUnreached && l > deepest) {
+        deepest = l;
+      }
+    }
+    cout << reached << " reached, " << deepest << " levels" << endl;
+  } else {
+    vector<uint32_t> component;
+    cout << graph.weakComponents(component) << " weak components" << endl;
+  }
+  cerr << "done in " << secondsSince(start) << "s, "
+       << graph.getBytesRead() / 1048576 << "MB read" << endl;
+  return graph.failed() ? 1 : 0;
+}
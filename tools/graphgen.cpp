@@ -0,0 +1,120 @@
+/**
+ * Command line front end for GraphGenerator
+ * Writes a synthetic graph as a readFile fixture or a binary edge file
+ *
+ * graphgen --topology rmat --vertices 1000000 --edges 16000000 \
+ *          --seed 7 --weights uniform --min-weight 1 --max-weight 100 \
+ *          --format text --output big.txt
+ */
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "graphgenerator.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// This is 80 characters - Keep all lines under 80 characters                 //
+////////////////////////////////////////////////////////////////////////////////
+
+using namespace std;
+
+void usage() {
+  cerr << "usage: graphgen [--topology chain|grid|erdos-renyi|rmat|geometric]"
+       << "\n                [--vertices N] [--edges M] [--seed S]"
+       << "\n                [--weights constant|uniform|exponential]"
+       << "\n                [--min-weight W] [--max-weight W]"
+       << "\n                [--format text|binary] [--output FILE]"
+       << "\n                [--count-only]"
+       << "\n--edges is the average out degree times N for geometric"
+       << "\nwrites to stdout when --output is not given" << endl;
+}
+
+int main(int argc, char* argv[]) {
+  GeneratorOptions options;
+  string format = "text";
+  string output;
+  bool countOnly = false;
+
+  for (int i = 1; i < argc; ++i) {
+    string flag = argv[i];
+    if (flag == "--count-only") {
+      countOnly = true;
+      continue;
+    }
+    if (i + 1 >= argc) {
+      usage();
+      return 1;
+    }
+    string value = argv[++i];
+    if (flag == "--topology") {
+      if (!GraphGenerator::parseTopology(value, options.topology)) {
+        cerr << "ERROR: unknown topology " << value << endl;
+        return 1;
+      }
+    } else if (flag == "--weights") {
+      if (!GraphGenerator::parseWeights(value, options.weights)) {
+        cerr << "ERROR: unknown weight distribution " << value << endl;
+        return 1;
+      }
+    } else if (flag == "--vertices") {
+      options.vertices = strtoull(value.c_str(), nullptr, 10);
+    } else if (flag == "--edges") {
+      options.edges = strtoull(value.c_str(), nullptr, 10);
+    } else if (flag == "--seed") {
+      options.seed = strtoull(value.c_str(), nullptr, 10);
+    } else if (flag == "--min-weight") {
+      options.minWeight = atoi(value.c_str());
+    } else if (flag == "--max-weight") {
+      options.maxWeight = atoi(value.c_str());
+    } else if (flag == "--format") {
+      format = value;
+    } else if (flag == "--output") {
+      output = value;
+    } else {
+      usage();
+      return 1;
+    }
+  }
+
+  GraphGenerator generator(options);
+  string error;
+  if (!generator.check(error)) {
+    cerr << "ERROR: " << error << endl;
+    return 1;
+  }
+  if (countOnly) {
+    cout << generator.vertexCount() << " vertices "
+         << generator.edgeCount() << " edges" << endl;
+    return 0;
+  }
+
+  // big buffer so 100M edge outputs are not dominated by write calls
+  vector<char> buffer(1 << 20);
+  ofstream file;
+  if (!output.empty()) {
+    file.rdbuf()->pubsetbuf(buffer.data(), buffer.size());
+    file.open(output, format == "binary" ? ios::out | ios::binary : ios::out);
+    if (file.fail()) {
+      cerr << "ERROR: cannot open " << output << endl;
+      return 1;
+    }
+  }
+  ostream& out = output.empty() ? cout : file;
+
+  unique_ptr<EdgeSink> sink;
+  if (format == "text") {
+    sink.reset(new TextEdgeWriter(out));
+  } else if (format == "binary") {
+    sink.reset(new BinaryEdgeWriter(out));
+  } else {
+    cerr << "ERROR: unknown format " << format << endl;
+    return 1;
+  }
+
+  generator.generate(*sink, error);
+  return out.fail() ? 1 : 0;
+}
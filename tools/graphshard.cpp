@@ -0,0 +1,135 @@
+/**
+ * Command line front end for Partition and ShardedGraph
+ * Loads a readFile graph, splits it into shards worker processes and
+ * times breadth-first searches and shortest paths between random vertices,
+ * so runs with different --shards show how the queries scale
+ *
+ * graphshard --graph grid1m.txt --shards 4 --queries 100
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "graph.h"
+#include "indexedgraph.h"
+#include "partition.h"
+#include "shardedgraph.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// This is 80 characters - Keep all lines under 80 characters                 //
+////////////////////////////////////////////////////////////////////////////////
+
+using namespace std;
+
+void usage() {
+  cerr << "usage: graphshard --graph FILE [--shards N] [--queries N]"
+       << "\n                  [--imbalance F] [--seed N]" << endl;
+}
+
+double secondsSince(chrono::steady_clock::time_point start) {
+  return chrono::duration<double>(chrono::steady_clock::now() - start)
+      .count();
+}
+
+int main(int argc, char* argv[]) {
+  string graphFile;
+  int shards = 4;
+  int queries = 100;
+  double imbalance = 0.03;
+  unsigned seed = 1;
+  for (int i = 1; i + 1 < argc; i += 2) {
+    string flag = argv[i];
+    string value = argv[i + 1];
+    if (flag == "--graph") {
+      graphFile = value;
+    } else if (flag == "--shards") {
+      shards = atoi(value.c_str());
+    } else if (flag == "--queries") {
+      queries = atoi(value.c_str());
+    } else if (flag == "--imbalance") {
+      imbalance = atof(value.c_str());
+    } else if (flag == "--seed") {
+      seed = static_cast<unsigned>(strtoul(value.c_str(), nullptr, 10));
+    } else {
+      usage();
+      return 1;
+    }
+  }
+  if (argc % 2 == 0 || graphFile.empty() || shards < 1) {
+    usage();
+    return 1;
+  }
+
+  Graph graph;
+  graph.readFile(graphFile);
+  IndexedGraph indexed(graph);
+  int n = indexed.getNumVertices();
+  if (n == 0) {
+    cerr << "ERROR: " << graphFile << " has no vertices" << endl;
+    return 1;
+  }
+
+  chrono::steady_clock::time_point start = chrono::steady_clock::now();
+  Partition partition(indexed, shards, imbalance, seed);
+  cerr << n << " vertices " << indexed.getNumEdges() << " edges, "
+       << partition.getEdgeCut() << " cut, partitioned in "
+       << secondsSince(start) << "s" << endl;
+  for (int p = 0; p < shards; ++p) {
+    cerr << "  shard " << p << ": " << partition.getPartSizes()[p]
+         << " vertices" << endl;
+  }
+
+  ShardedGraph sharded(indexed, partition);
+  string error;
+  start = chrono::steady_clock::now();
+  if (!sharded.start(error)) {
+    cerr << "ERROR: " << error << endl;
+    return 1;
+  }
+  cerr << "workers loaded in " << secondsSince(start) << "s" << endl;
+
+  mt19937 rng(seed);
+  uniform_int_distribution<int> vertex(0, n - 1);
+  vector<int> level;
+  vector<string> path;
+  ShardStats breadthFirst;
+  ShardStats shortest;
+  double breadthFirstSeconds = 0;
+  double shortestSeconds = 0;
+  for (int q = 0; q < queries && !sharded.failed(); ++q) {
+    const string& from = indexed.getLabel(vertex(rng));
+    const string& to = indexed.getLabel(vertex(rng));
+    start = chrono::steady_clock::now();
+    sharded.breadthFirstSearch(from, level);
+    breadthFirstSeconds += secondsSince(start);
+    breadthFirst.supersteps += sharded.getStats().supersteps;
+    breadthFirst.messages += sharded.getStats().messages;
+    breadthFirst.bytes += sharded.getStats().bytes;
+
+    start = chrono::steady_clock::now();
+    sharded.shortestPath(from, to, path);
+    shortestSeconds += secondsSince(start);
+    shortest.supersteps += sharded.getStats().supersteps;
+    shortest.messages += sharded.getStats().messages;
+    shortest.bytes += sharded.getStats().bytes;
+  }
+  if (sharded.failed()) {
+    cerr << "ERROR: a worker failed" << endl;
+    return 1;
+  }
+
+  double count = max(1, queries);
+  cout << "bfs:  " << breadthFirstSeconds * 1000 / count << " ms, "
+       << breadthFirst.supersteps / count << " supersteps, "
+       << breadthFirst.messages / count << " messages, "
+       << breadthFirst.bytes / count / 1024 << " KB a query" << endl;
+  cout << "path: " << shortestSeconds * 1000 / count << " ms, "
+       << shortest.supersteps / count << " supersteps, "
+       << shortest.messages / count << " messages, "
+       << shortest.bytes / count / 1024 << " KB a query" << endl;
+  return 0;
+}
@@ -0,0 +1,73 @@
+#include "unionfind.h"
+
+#include <utility>
+
+////////////////////////////////////////////////////////////////////////////////
+// This is 80 characters - Keep all lines under 80 characters                 //
+////////////////////////////////////////////////////////////////////////////////
+
+/** every id starts in a set of its own */
+ConcurrentUnionFind::ConcurrentUnionFind(int size)
+    : count(size), parent(new std::atomic<int>[size]) {
+  for (int v = 0; v < size; ++v) {
+    parent[v].store(v, std::memory_order_relaxed);
+  }
+}
+
+/** return number of ids */
+int ConcurrentUnionFind::size() const {
+  return count;
+}
+
+/** return the root of v's set, halving the path on the way up
+    a lost compare-and-swap only means someone else shortened it first */
+int ConcurrentUnionFind::find(int v) {
+  while (true) {
+    int up = parent[v].load(std::memory_order_acquire);
+    if (up == v) {
+      return v;
+    }
+    int grandparent = parent[up].load(std::memory_order_acquire);
+    if (up != grandparent) {
+      parent[v].compare_exchange_weak(up, grandparent,
+                                      std::memory_order_acq_rel);
+    }
+    v = grandparent;
+  }
+}
+
+/** merge the sets of a and b
+    @return  true if this call merged them, false if already one set */
+bool ConcurrentUnionFind::unite(int a, int b) {
+  while (true) {
+    a = find(a);
+    b = find(b);
+    if (a == b) {
+      return false;
+    }
+    if (a < b) {
+      std::swap(a, b);
+    }
+    // a is still a root only if no other thread linked it meanwhile
+    int expected = a;
+    if (parent[a].compare_exchange_strong(expected, b,
+                                          std::memory_order_acq_rel)) {
+      return true;
+    }
+  }
+}
+
+/** return true if a and b are in the same set */
+bool ConcurrentUnionFind::sameSet(int a, int b) {
+  while (true) {
+    a = find(a);
+    b = find(b);
+    if (a == b) {
+      return true;
+    }
+    // a root that is still a root means the answer was true when read
+    if (parent[a].load(std::memory_order_acquire) == a) {
+      return false;
+    }
+  }
+}
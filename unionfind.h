@@ -0,0 +1,40 @@
+/**
+ * Lock-free disjoint sets over the ids 0 .. size - 1
+ * Any number of threads may call find and unite at once. Parents are
+ * std::atomic ints: find halves the path with compare-and-swap, and unite
+ * always hangs the larger root under the smaller one, so racing threads
+ * can never build a cycle. A lost compare-and-swap only means another
+ * thread got there first, and the operation retries from the new roots.
+ */
+
+#ifndef UNIONFIND_H
+#define UNIONFIND_H
+
+#include <atomic>
+#include <memory>
+
+class ConcurrentUnionFind {
+ public:
+    /** every id starts in a set of its own */
+    explicit ConcurrentUnionFind(int size);
+
+    /** return number of ids */
+    int size() const;
+
+    /** return the root of v's set
+        stable once no thread is calling unite */
+    int find(int v);
+
+    /** merge the sets of a and b
+        @return  true if this call merged them, false if already one set */
+    bool unite(int a, int b);
+
+    /** return true if a and b are in the same set */
+    bool sameSet(int a, int b);
+
+ private:
+    int count;
+    std::unique_ptr<std::atomic<int>[]> parent;
+};
+
+#endif  // UNIONFIND_H
@@ -14,7 +14,8 @@
 /** Creates an unvisited vertex, gives it a label, and clears its
     adjacency list.
     NOTE: A vertex must have a unique label that cannot be changed. */
-Vertex::Vertex(std::string label) {
+template <typename Label, typename Weight>
+BasicVertex<Label, Weight>::BasicVertex(const Label& label) {
   visited = false;
   vertexLabel = label;
 }
@@ -22,30 +23,36 @@ Vertex::Vertex(std::string label) {
 //Vertex::Vertex(std::)
 
 /** @return  The label of this vertex. */
-std::string Vertex::getLabel() const { return vertexLabel; }
+template <typename Label, typename Weight>
+Label BasicVertex<Label, Weight>::getLabel() const { return vertexLabel; }
 
 /** Marks this vertex as visited. */
-void Vertex::visit() { visited = true; }
+template <typename Label, typename Weight>
+void BasicVertex<Label, Weight>::visit() { visited = true; }
 
 /** Marks this vertex as not visited. */
-void Vertex::unvisit() { visited = false; }
+template <typename Label, typename Weight>
+void BasicVertex<Label, Weight>::unvisit() { visited = false; }
 
 /** Returns the visited status of this vertex.
  @return  True if the vertex has been visited, otherwise
     returns false/ */
-bool Vertex::isVisited() const { return visited; }
+template <typename Label, typename Weight>
+bool BasicVertex<Label, Weight>::isVisited() const { return visited; }
 
 /** Adds an edge between this vertex and the given vertex.
     Cannot have multiple connections to the same endVertex
     Cannot connect back to itself
  @return  True if the connection is successful. */
-bool Vertex::connect(const std::string& endVertex, const int edgeWeight) {
+template <typename Label, typename Weight>
+bool BasicVertex<Label, Weight>::connect(const Label& endVertex,
+                                         const Weight edgeWeight) {
 
   if (endVertex == vertexLabel) {
     return false;
   }
 
-  Edge hopper(endVertex, edgeWeight);
+  EdgeType hopper(endVertex, edgeWeight);
 
   //emplace() only allows one entry per key
   //Get state via returned pair's bool
@@ -54,7 +61,8 @@ bool Vertex::connect(const std::string& endVertex, const int edgeWeight) {
 
 /** Removes the edge between this vertex and the given one.
 @return  True if the removal is successful. */
-bool Vertex::disconnect(const std::string& endVertex) {
+template <typename Label, typename Weight>
+bool BasicVertex<Label, Weight>::disconnect(const Label& endVertex) {
   // I could use at() and catch the exception,
   //  but that feels too jank and unclear.
   // same complexity anyhow
@@ -63,9 +71,11 @@ bool Vertex::disconnect(const std::string& endVertex) {
 }
 
 /** Gets the weight of the edge between this vertex and the given vertex.
- @return  The edge weight. This value is zero for an unweighted graph and
+ @return  The edge weight. This value is one for an unweighted graph and
     is negative if the .edge does not exist */
-int Vertex::getEdgeWeight(const std::string& endVertex) const {
+template <typename Label, typename Weight>
+typename BasicVertex<Label, Weight>::Cost
+BasicVertex<Label, Weight>::getEdgeWeight(const Label& endVertex) const {
   // finds the vert, test if not found
 
   // using auto because listing the whole template will be unreadable
@@ -76,25 +86,30 @@ int Vertex::getEdgeWeight(const std::string& endVertex) const {
     return -1;
   }
 
-  return it->second.getWeight();
+  return WeightTraits<Weight>::cost(it->second.getWeight());
 }
 
 /** Calculates how many neighbors this vertex has.
  @return  The number of the vertex's neighbors. */
-int Vertex::getNumberOfNeighbors() const {
+template <typename Label, typename Weight>
+int BasicVertex<Label, Weight>::getNumberOfNeighbors() const {
   // going to assume that a vertex can be a neighbor to itself
 
   return adjacencyList.size();
 }
 
 /** Sets current neighbor to first in adjacency list. */
-void Vertex::resetNeighbor() { currentNeighbor = adjacencyList.begin(); }
+template <typename Label, typename Weight>
+void BasicVertex<Label, Weight>::resetNeighbor() {
+  currentNeighbor = adjacencyList.begin();
+}
 
 /** Gets this vertex's next neighbor in the adjacency list.
     Neighbors are automatically sorted alphabetically via map
     Returns the vertex label if there are no more neighbors
  @return  The label of the vertex's next neighbor. */
-std::string Vertex::getNextNeighbor() { 
+template <typename Label, typename Weight>
+Label BasicVertex<Label, Weight>::getNextNeighbor() { 
   if (currentNeighbor == adjacencyList.end()) {
     return vertexLabel;
   }
@@ -103,15 +118,38 @@ std::string Vertex::getNextNeighbor() {
   return (currentNeighbor++)->first;
 }
 
+/** Calls visit on every edge in adjacency list (alphabetical) order.
+    Unlike getNextNeighbor this does not move currentNeighbor. */
+template <typename Label, typename Weight>
+void BasicVertex<Label, Weight>::forEachNeighbor(
+    const std::function<void(const EdgeType&)>& visit) const {
+  for (const auto& neighbor : adjacencyList) {
+    visit(neighbor.second);
+  }
+}
+
 /** Sees whether this vertex is equal to another one.
     Two vertices are equal if they have the same label. */
-bool Vertex::operator==(const Vertex& rightHandItem) const {
+template <typename Label, typename Weight>
+bool BasicVertex<Label, Weight>::operator==(
+    const BasicVertex& rightHandItem) const {
   return rightHandItem.vertexLabel == vertexLabel;
 }
 
 /** Sees whether this vertex is < another one.
     Compares vertexLabel. */
-bool Vertex::operator<(const Vertex& rightHandItem) const {
+template <typename Label, typename Weight>
+bool BasicVertex<Label, Weight>::operator<(
+    const BasicVertex& rightHandItem) const {
   return vertexLabel < rightHandItem.vertexLabel;
 }
 
+// the label and weight types BasicGraph supports
+template class BasicVertex<std::string, int>;
+template class BasicVertex<std::string, long long>;
+template class BasicVertex<std::string, double>;
+template class BasicVertex<std::string, Unweighted>;
+template class BasicVertex<int, int>;
+template class BasicVertex<int, long long>;
+template class BasicVertex<int, double>;
+template class BasicVertex<int, Unweighted>;
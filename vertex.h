@@ -4,6 +4,9 @@
  * Cannot be connected to itself
  * Used by depth-first search and breadth-first search
  * to keep track of if it has been visited or not
+ *
+ * BasicVertex is templated over the label and weight types,
+ * Vertex is the std::string / int vertex the assignment uses
  */
 
 #ifndef VERTEX_H
@@ -15,15 +18,19 @@
 
 #include "edge.h"
 
-class Vertex {
+template <typename Label, typename Weight>
+class BasicVertex {
  public:
+    typedef BasicEdge<Label, Weight> EdgeType;
+    typedef typename WeightTraits<Weight>::Cost Cost;
+
     /** Creates an unvisited vertex, gives it a label, and clears its
         adjacency list.
         NOTE: A vertex must have a unique label that cannot be changed. */
-    explicit Vertex(std::string label);
+    explicit BasicVertex(const Label& label);
 
     /** @return  The label of this vertex. */
-    std::string getLabel() const;
+    Label getLabel() const;
 
     /** Marks this vertex as visited. */
     void visit();
@@ -40,16 +47,16 @@ class Vertex {
         Cannot have multiple connections to the same endVertex
         Cannot connect back to itself
      @return  True if the connection is successful. */
-    bool connect(const std::string& endVertex, const int edgeWeight = 0);
+    bool connect(const Label& endVertex, const Weight edgeWeight = Weight());
 
     /** Removes the edge between this vertex and the given one.
     @return  True if the removal is successful. */
-    bool disconnect(const std::string& endVertex);
+    bool disconnect(const Label& endVertex);
 
     /** Gets the weight of the edge between this vertex and the given vertex.
-     @return  The edge weight. This value is zero for an unweighted graph and
+     @return  The edge weight. This value is one for an unweighted graph and
         is negative if the .edge does not exist */
-    int getEdgeWeight(const std::string& endVertex) const;
+    Cost getEdgeWeight(const Label& endVertex) const;
 
     /** Calculates how many neighbors this vertex has.
      @return  The number of the vertex's neighbors. */
@@ -62,29 +69,37 @@ class Vertex {
         Neighbors are automatically sorted alphabetically via map
         Returns the vertex label if there are no more neighbors
      @return  The label of the vertex's next neighbor. */
-    std::string getNextNeighbor();
+    Label getNextNeighbor();
+
+    /** Calls visit on every edge in adjacency list (alphabetical) order.
+        Unlike getNextNeighbor this does not move currentNeighbor. */
+    void forEachNeighbor(const std::function<void(const EdgeType&)>& visit)
+        const;
     
 
     /** Sees whether this vertex is equal to another one.
         Two vertices are equal if they have the same label. */
-    bool operator==(const Vertex& rightHandItem) const;
+    bool operator==(const BasicVertex& rightHandItem) const;
 
     /** Sees whether this vertex is < another one.
         Compares vertexLabel. */
-    bool operator<(const Vertex& rightHandItem) const;
+    bool operator<(const BasicVertex& rightHandItem) const;
 
  private:
     /** the unique label for the vertex */
-    std::string vertexLabel;
+    Label vertexLabel;
 
     /** True if the vertex is visited */
     bool visited {false};
 
     /** adjacencyList as an ordered map, in alphabetical order */
-    std::map<std::string, Edge, std::less<std::string>> adjacencyList;
+    std::map<Label, EdgeType, std::less<Label>> adjacencyList;
 
     /** iterator showing which neighbor we are currently at */
-    std::map<std::string, Edge>::iterator currentNeighbor;
+    typename std::map<Label, EdgeType>::iterator currentNeighbor;
 };
 
+/** the vertex used by the assignment */
+typedef BasicVertex<std::string, int> Vertex;
+
 #endif  // VERTEX_H